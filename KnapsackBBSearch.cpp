@@ -0,0 +1,336 @@
+//===-- KnapsackBBSearch.cpp - Branch and Bound over a Bound --------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackBBSearch class template, which searches a
+/// 0/1 knapsack problem's tree by Branch and Bound with the bound given as a
+/// policy type, and the KnapsackBBSearchBase class it shares its state with.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackBBSearch.h"
+#include <algorithm>
+
+void KnapsackBBSearchBase::start(KnapsackInstance *instance_,
+                                 KnapsackSolution *solution_, bool sortItems) {
+
+  deadline.Start();
+  countdown.Reset(deadline);
+
+  instance = instance_;
+  bestSolution = solution_;
+  currentSolution.reset(new KnapsackSolution(instance));
+
+  bestValue = -1;
+  takenValue = takenWeight = 0;
+  nodeCount = 0;
+  openBound = 0;
+
+  itemCount = instance->GetItemCnt();
+  capacity = instance->GetCapacity();
+
+  stats.Start(itemCount);
+
+  items.clear();
+  items.reserve(itemCount);
+
+  for (int i = 0; i < itemCount; ++i) {
+
+    items.emplace_back(Item{i + 1, instance->GetItemWeight(i + 1),
+                            instance->GetItemValue(i + 1)});
+  }
+
+  if (sortItems) {
+    std::stable_sort(items.begin(), items.end(),
+                     KnapsackUpperBounds::ByRatio<Item>);
+  }
+
+  // Start from a good solution, so that the bounds prune from the first node
+  // on
+  if (warmStarting) {
+    KnapsackSolution warmSolution(instance);
+
+    warmStart.Solve(instance, &warmSolution);
+    bestSolution->Copy(&warmSolution);
+    bestValue = bestSolution->GetValue();
+    stats.Improve(bestValue);
+  }
+}
+
+void KnapsackBBSearchBase::recoverBestNode() {
+
+  // If no node beat the warm start, its solution is already in place.
+  // Otherwise, every node has the decision for the item before it, so walk up
+  // from the best node to recover the solution.
+  if (nodePool[bestNode].value == bestValue) {
+
+    for (int i = 1; i <= itemCount; ++i) {
+      bestSolution->DontTakeItem(i);
+    }
+
+    for (uint32_t node = bestNode; node != NodePool::noNode;
+         node = nodePool[node].parent) {
+
+      if (nodePool[node].taken) {
+        bestSolution->TakeItem(
+            items[nodePool[node].depth - 1].originalPosition);
+      }
+    }
+  }
+
+  bestSolution->ComputeValue();
+}
+
+uint32_t const KnapsackBBSearchBase::NodePool::noNode;
+
+void KnapsackBBSearchBase::NodePool::Clear() {
+  nodes.clear();
+  freeNodes.clear();
+}
+
+uint32_t KnapsackBBSearchBase::NodePool::Allocate(SearchNode const &node) {
+
+  uint32_t index;
+
+  if (freeNodes.empty()) {
+    index = nodes.size();
+    nodes.push_back(node);
+  } else {
+    index = freeNodes.back();
+    freeNodes.pop_back();
+    nodes[index] = node;
+  }
+
+  nodes[index].references = 1;
+
+  if (node.parent != noNode) {
+    ++nodes[node.parent].references;
+  }
+  return index;
+}
+
+void KnapsackBBSearchBase::NodePool::Release(uint32_t node) {
+
+  while (node != noNode && --nodes[node].references == 0) {
+    freeNodes.push_back(node);
+    node = nodes[node].parent;
+  }
+}
+
+template <typename Bound>
+void KnapsackBBSearch<Bound>::Solve(KnapsackInstance *instance_,
+                                    KnapsackSolution *solution_) {
+
+  start(instance_, solution_, Bound::sortsItems);
+  bound.Assign(items);
+
+  if (search != BB_DEPTH_FIRST) {
+    solveBestFirst();
+    return;
+  }
+
+  findSolutions(0);
+}
+
+template <typename Bound>
+void KnapsackBBSearch<Bound>::findSolutions(size_t itemNum) {
+
+  // If time has run out, exit early, leaving this node's subtree unsearched
+  if (isOutOfTime()) {
+    openBound = std::max<int64_t>(
+        openBound, takenValue + bound(itemNum, capacity - takenWeight));
+    return;
+  }
+
+  ++nodeCount;
+  stats.Node(itemNum);
+
+  // If this is a leaf node (all items have been chosen)
+  if (itemNum == (size_t)itemCount) {
+
+    stats.Leaf(itemNum);
+
+    // Update the best value so-far
+    if (takenValue > bestValue) {
+      bestSolution->Copy(currentSolution.get());
+      bestValue = bestSolution->ComputeValue();
+      stats.Improve(bestValue);
+    }
+    return;
+  }
+
+  auto itemWeight = items[itemNum].weight;
+  auto itemValue = items[itemNum].value;
+
+  if ((int64_t)takenWeight + itemWeight <= (int64_t)capacity) {
+
+    takenWeight += itemWeight;
+    takenValue += itemValue;
+
+    currentSolution->TakeItem(items[itemNum].originalPosition);
+
+    findSolutions(itemNum + 1);
+
+    takenWeight -= itemWeight;
+    takenValue -= itemValue;
+
+    currentSolution->DontTakeItem(items[itemNum].originalPosition);
+  } else {
+    stats.CapacityPrune(itemNum + 1);
+  }
+
+  // Skip the item only if the items after it could still beat the best
+  // solution found so far
+  auto skipBound = stats.TimeBound(
+      [&] { return bound(itemNum + 1, capacity - takenWeight); });
+
+  if (takenValue + skipBound <= bestValue) {
+    stats.BoundPrune(itemNum + 1);
+    return;
+  }
+
+  findSolutions(itemNum + 1);
+}
+
+template <typename Bound> void KnapsackBBSearch<Bound>::solveBestFirst() {
+
+  nodePool.Clear();
+  openNodes = std::priority_queue<OpenNode>();
+
+  // The root has decided nothing. Taking nothing is a valid solution, so the
+  // root is also the first best solution.
+  int64_t rootBound = stats.TimeBound([&] { return bound(0, capacity); });
+  uint32_t root = nodePool.Allocate(
+      SearchNode{0, 0, rootBound, 0, NodePool::noNode, 0, false});
+
+  bestNode = root;
+  bestValue = std::max<int64_t>(bestValue, 0);
+  nodePool.AddReference(bestNode);
+
+  // The root's own reference now belongs to the open queue
+  openNodes.push(OpenNode{rootBound, 0, root});
+
+  while (!openNodes.empty() && !deadline.IsExpired()) {
+
+    OpenNode open = openNodes.top();
+    openNodes.pop();
+
+    // The incumbent may have improved since this node was left open
+    if (open.bound > bestValue) {
+      branch(open.node, search == BB_HYBRID);
+    } else {
+      stats.BoundPrune(open.depth);
+    }
+
+    nodePool.Release(open.node);
+  }
+
+  // Whatever is left open when time runs out is unsearched
+  if (!openNodes.empty()) {
+    openBound = std::max(openBound, openNodes.top().bound);
+  }
+
+  recoverBestNode();
+}
+
+template <typename Bound>
+void KnapsackBBSearch<Bound>::branch(uint32_t node, bool dive) {
+
+  // Copied, since allocating children may move the pool's storage
+  SearchNode parent = nodePool[node];
+
+  if (parent.depth == (uint32_t)itemCount) {
+    return;
+  }
+
+  if (isOutOfTime()) {
+    openBound = std::max(openBound, parent.bound);
+    return;
+  }
+
+  ++nodeCount;
+  stats.Node(parent.depth);
+
+  Item const &item = items[parent.depth];
+  uint32_t children[2];
+  size_t childCount = 0;
+
+  // Create the child that takes the item (if it fits) and the one that
+  // skips it, leaving out any whose bound cannot beat the best solution.
+  for (bool taken : {true, false}) {
+
+    // Summed in int64_t, so that a weight past the capacity cannot overflow
+    int64_t weight = (int64_t)parent.weight + (taken ? item.weight : 0);
+    int64_t value = parent.value + (taken ? item.value : 0);
+
+    if (weight > (int64_t)capacity) {
+      stats.CapacityPrune(parent.depth + 1);
+      continue;
+    }
+
+    int64_t childBound = value + stats.TimeBound([&] {
+      return bound(parent.depth + 1, capacity - weight);
+    });
+
+    if (childBound <= bestValue) {
+      stats.BoundPrune(parent.depth + 1);
+      continue;
+    }
+
+    uint32_t child = nodePool.Allocate(SearchNode{(int32_t)weight, value,
+                                                  childBound, parent.depth + 1,
+                                                  node, 0, taken});
+
+    // Every node is a valid solution: take nothing more.
+    if (value > bestValue) {
+      nodePool.Release(bestNode);
+      bestNode = child;
+      bestValue = value;
+      nodePool.AddReference(bestNode);
+      stats.Improve(bestValue);
+    }
+
+    children[childCount++] = child;
+  }
+
+  // Search the more promising child first
+  if (childCount == 2 &&
+      nodePool[children[1]].bound > nodePool[children[0]].bound) {
+    std::swap(children[0], children[1]);
+  }
+
+  for (size_t i = 0; i < childCount; ++i) {
+
+    uint32_t child = children[i];
+    SearchNode const &childNode = nodePool[child];
+
+    // Leaves have nothing left to decide, and other nodes may have been
+    // overtaken by the best solution since they were created.
+    if (childNode.depth == (uint32_t)itemCount) {
+      stats.Leaf(childNode.depth);
+      nodePool.Release(child);
+      continue;
+    }
+
+    if (childNode.bound <= bestValue) {
+      stats.BoundPrune(childNode.depth);
+      nodePool.Release(child);
+      continue;
+    }
+
+    if ((!dive || i > 0) && nodePool.GetLiveCount() < maxNodes) {
+      openNodes.push(OpenNode{childNode.bound, childNode.depth, child});
+      continue;
+    }
+
+    branch(child, true);
+    nodePool.Release(child);
+  }
+}
+
+template class KnapsackBBSearch<UB1Bound>;
+template class KnapsackBBSearch<UB2Bound>;
+template class KnapsackBBSearch<UB3Bound>;
+template class KnapsackBBSearch<UB4Bound>;
+template class KnapsackBBSearch<UB5Bound>;
@@ -0,0 +1,193 @@
+//===-- KnapsackBBSearch.h - Branch and Bound over a Bound ------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackBBSearch class template, which searches a
+/// 0/1 knapsack problem's tree by Branch and Bound with the bound given as a
+/// policy type, and the KnapsackBBSearchBase class it shares its state with.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKBBSEARCH_H
+#define KNAPSACKBBSEARCH_H
+
+#include "KnapsackDeadline.h"
+#include "KnapsackSearchStats.h"
+#include "KnapsackUpperBounds.h"
+#include "KnapsackWarmStart.h"
+#include "knapsack.h"
+#include <algorithm>
+#include <memory>
+#include <queue>
+
+/// The state and steps of a Branch and Bound search that do not depend on
+/// the bound.
+class KnapsackBBSearchBase {
+protected:
+  struct Item {
+    /// Specifies the position of this item in the original item list of the
+    /// KnapsackInstance.
+    int originalPosition;
+    int weight;
+    int64_t value;
+  };
+
+  /// A node of the search tree for BB_BEST_FIRST and BB_HYBRID. A node at
+  /// depth d has decided items [0, d), and its own decision is that of item
+  /// d-1. The rest of its decisions are found by following `parent`.
+  struct SearchNode {
+    int32_t weight;
+    int64_t value;
+    /// The bound on every solution below this node
+    int64_t bound;
+    uint32_t depth;
+    uint32_t parent;
+    /// The number of owners keeping this node alive: its live children, the
+    /// open queue, the search frame expanding it, and the best solution.
+    uint32_t references;
+    bool taken;
+  };
+
+  /// Allocates search nodes from one growing array, reusing released ones,
+  /// so that the search does no allocation per node.
+  class NodePool {
+    std::vector<SearchNode> nodes;
+    std::vector<uint32_t> freeNodes;
+
+  public:
+    static uint32_t const noNode = UINT32_MAX;
+
+    void Clear();
+
+    /// Allocate a node holding one reference, and add a reference to its
+    /// parent.
+    uint32_t Allocate(SearchNode const &node);
+
+    void AddReference(uint32_t node) { ++nodes[node].references; }
+
+    /// Drop one reference to a node. A node without references is released,
+    /// and drops its reference to its parent.
+    void Release(uint32_t node);
+
+    SearchNode &operator[](uint32_t node) { return nodes[node]; }
+
+    size_t GetLiveCount() const { return nodes.size() - freeNodes.size(); }
+  };
+
+  struct OpenNode {
+    int64_t bound;
+    uint32_t depth;
+    uint32_t node;
+
+    /// Order by bound, then deeper first, which reaches leaves sooner.
+    bool operator<(OpenNode const &other) const {
+      return bound != other.bound ? bound < other.bound : depth < other.depth;
+    }
+  };
+
+  BB_SEARCH const search;
+  /// The most nodes BB_BEST_FIRST and BB_HYBRID keep alive. Past this, new
+  /// branches are searched depth-first instead of being left open.
+  size_t const maxNodes;
+  KnapsackInstance *instance = nullptr;
+  std::unique_ptr<KnapsackSolution> currentSolution;
+  KnapsackSolution *bestSolution = nullptr;
+  KnapsackDeadline deadline;
+  KnapsackDeadline::Countdown countdown;
+  // Values are summed in int64_t, since the values of items that fit
+  // together may add up to more than any one of them can hold
+  int64_t bestValue = 0, takenValue = 0;
+  int32_t takenWeight = 0, itemCount = 0;
+  /// The largest bound of a subtree left unsearched when the deadline passed
+  int64_t openBound = 0;
+  std::vector<Item> items;
+  uint32_t capacity = 0;
+
+  uint64_t nodeCount = 0;
+  KnapsackSearchStats stats;
+
+  KnapsackWarmStart warmStart;
+  bool warmStarting = true;
+
+  // Used for BB_BEST_FIRST and BB_HYBRID
+  NodePool nodePool;
+  std::priority_queue<OpenNode> openNodes;
+  uint32_t bestNode = NodePool::noNode;
+
+  KnapsackBBSearchBase(BB_SEARCH search, size_t maxNodes)
+      : search(search), maxNodes(maxNodes) {}
+
+  /// Set up a search: read the items, sorting them by value / weight if
+  /// `sortItems` is set, and take the warm start solution.
+  void start(KnapsackInstance *instance, KnapsackSolution *solution,
+             bool sortItems);
+
+  /// Record the best node's solution, unless no node beat the warm start.
+  void recoverBestNode();
+
+  /// Count a node, and get whether the deadline has passed.
+  bool isOutOfTime() { return countdown.Expired(); }
+
+public:
+  virtual ~KnapsackBBSearchBase() = default;
+
+  virtual void Solve(KnapsackInstance *instance,
+                     KnapsackSolution *solution) = 0;
+
+  /// Set whether to start from a KnapsackWarmStart solution, rather than from
+  /// taking nothing.
+  void SetWarmStart(bool enabled) { warmStarting = enabled; }
+
+  /// Get the number of search tree nodes the last Solve() explored.
+  uint64_t GetNodeCount() const { return nodeCount; }
+
+  /// Get the limits on every Solve(), or cancel a running one.
+  KnapsackDeadline &GetDeadline() { return deadline; }
+
+  /// Get the least upper bound on the optimum the last Solve() proved. This
+  /// is the solution's value, unless the deadline stopped the search.
+  int64_t GetUpperBound() const { return std::max(bestValue, openBound); }
+
+  /// Get what the last Solve() did at each depth of the tree.
+  KnapsackSearchStats const &GetStats() const { return stats; }
+};
+
+/// Provides a solution for a 0/1 Knapsack Problem using Branch and Bound,
+/// pruning with the bound policy `Bound` (see KnapsackUpperBounds.h).
+///
+/// Each policy gets its own search, with the bound inlined at every node and
+/// only the state that bound needs.
+template <typename Bound> class KnapsackBBSearch : public KnapsackBBSearchBase {
+private:
+  Bound bound;
+
+  void findSolutions(size_t itemNum);
+
+  void solveBestFirst();
+
+  /// Create the children of a node and either leave them open or search them
+  /// depth-first. When `dive` is set, the most promising child is always
+  /// searched depth-first.
+  void branch(uint32_t node, bool dive);
+
+public:
+  /// \param search The order in which to explore the search tree
+  /// \param maxNodes The most search nodes to keep alive when exploring
+  /// best-first
+  explicit KnapsackBBSearch(BB_SEARCH const search = BB_DEPTH_FIRST,
+                            size_t const maxNodes = 1 << 22)
+      : KnapsackBBSearchBase(search, maxNodes) {}
+
+  void Solve(KnapsackInstance *instance, KnapsackSolution *solution) override;
+
+  Bound &GetBound() { return bound; }
+};
+
+extern template class KnapsackBBSearch<UB1Bound>;
+extern template class KnapsackBBSearch<UB2Bound>;
+extern template class KnapsackBBSearch<UB3Bound>;
+extern template class KnapsackBBSearch<UB4Bound>;
+extern template class KnapsackBBSearch<UB5Bound>;
+
+#endif // KNAPSACKBBSEARCH_H
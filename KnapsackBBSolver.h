@@ -11,55 +11,59 @@
 #ifndef KNAPSACKBBSOLVER_H
 #define KNAPSACKBBSOLVER_H
 
+#include "KnapsackBBSearch.h"
 #include "knapsack.h"
+#include <memory>
 
+/// Chooses the KnapsackBBSearch specialization for a bound and search order
+/// at run time, so that the search itself never switches on the bound.
 class KnapsackBBSolver {
 private:
-  struct Item {
-    /// Specifies the position of this item in the original item list of the
-    /// KnapsackInstance.
-    int originalPosition;
-    int weight, value;
-  };
-
-  class FractionalKnapsack {
-
-    std::vector<Item> const &items;
-    int32_t valueSum, weightSum, fractionalValue, fractionalWeight, capacity;
-    size_t fractionalItemNum;
+  UPPER_BOUND const upperBound;
+  std::unique_ptr<KnapsackBBSearchBase> search;
 
-    void computeStartingFrom(size_t startingPoint);
+public:
+  /// \param upperBound The bound used to prune the depth-first search.
+  /// Best-first searches use UB3 in place of UB1 and UB2.
+  /// \param search The order in which to explore the search tree
+  /// \param maxNodes The most search nodes to keep alive when exploring
+  /// best-first
+  explicit KnapsackBBSolver(UPPER_BOUND const upperBound,
+                            BB_SEARCH const search = BB_DEPTH_FIRST,
+                            size_t const maxNodes = 1 << 22);
 
-  public:
-    FractionalKnapsack(std::vector<Item> const &items, uint32_t capacity);
-    void untake(size_t itemNum);
-    int32_t getSolution() { return valueSum + fractionalValue; }
-  };
+  void Solve(KnapsackInstance *instance, KnapsackSolution *solution) {
+    search->Solve(instance, solution);
+  }
 
-  UPPER_BOUND const upperBound;
-  KnapsackInstance *instance = nullptr;
-  KnapsackSolution *currentSolution = nullptr;
-  KnapsackSolution *bestSolution = nullptr;
-  std::chrono::high_resolution_clock::time_point startTime;
-  std::chrono::duration<double> maxDuration = std::chrono::seconds(10);
-  int32_t bestValue = 0, takenWeight = 0, takenValue = 0, itemCount = 0;
-  std::vector<Item> items;
-  uint32_t capacity = 0;
+  /// Solve within a budget, keeping the best solution found when it runs
+  /// out. The budget only applies to this call.
+  /// \return The solution's value, and how far from the optimum it may be
+  KnapsackAnytimeResult SolveAnytime(KnapsackInstance *instance,
+                                     KnapsackSolution *solution,
+                                     KnapsackBudget const &budget);
 
-  // Used for upper bound 1
-  int32_t maximumRemainingValue = 0;
+  /// Set whether to start from a KnapsackWarmStart solution, rather than from
+  /// taking nothing.
+  void SetWarmStart(bool enabled) { search->SetWarmStart(enabled); }
 
-  int32_t sumRemainingValuesThatFit(size_t itemNum, uint32_t capacity);
+  /// Set how many items UB5 decides before bounding with UB3, up to
+  /// KnapsackUpperBounds::maxEnumerationDepth. Deeper bounds are tighter,
+  /// but cost twice as much per extra item. Only a UB5 solver has a depth;
+  /// others ignore it.
+  void SetEnumerationDepth(unsigned depth);
 
-  void findSolutions(size_t itemNum, FractionalKnapsack fractionalKnapsack);
+  /// Get the number of search tree nodes the last Solve() explored.
+  uint64_t GetNodeCount() const { return search->GetNodeCount(); }
 
-public:
-  explicit KnapsackBBSolver(UPPER_BOUND const upperBound)
-      : upperBound(upperBound) {}
+  /// Get the limits on every Solve(), or cancel a running one.
+  KnapsackDeadline &GetDeadline() { return search->GetDeadline(); }
 
-  ~KnapsackBBSolver() = default;
+  /// Get the least upper bound on the optimum the last Solve() proved.
+  int64_t GetUpperBound() const { return search->GetUpperBound(); }
 
-  void Solve(KnapsackInstance *instance, KnapsackSolution *solution);
+  /// Get what the last Solve() did at each depth of the tree.
+  KnapsackSearchStats const &GetStats() const { return search->GetStats(); }
 };
 
 #endif // KNAPSACKBBSOLVER_H
@@ -9,16 +9,34 @@
 //===----------------------------------------------------------------------===//
 
 #include "KnapsackBTSolver.h"
-#include "Time.h"
 
 void KnapsackBTSolver::Solve(KnapsackInstance *instance_,
                              KnapsackSolution *solution_) {
 
-  startTime = getTime();
+  deadline.Start();
+  countdown.Reset(deadline);
 
   instance = instance_;
   bestSolution = solution_;
-  currentSolution = new KnapsackSolution(instance);
+  currentSolution.reset(new KnapsackSolution(instance));
+
+  capacity = instance->GetCapacity();
+  itemCount = instance->GetItemCnt();
+  weight = 0;
+
+  stats.Start(itemCount);
+
+  // Start from a good solution, which is kept if time runs out before a
+  // better one is found
+  if (warmStarting) {
+    warmStart.Solve(instance, currentSolution.get());
+    bestSolution->Copy(currentSolution.get());
+    stats.Improve(bestSolution->GetValue());
+
+    for (int i = 1; i <= instance->GetItemCnt(); ++i) {
+      currentSolution->DontTakeItem(i);
+    }
+  }
 
   findSolutions(1);
 }
@@ -28,31 +46,23 @@ void KnapsackBTSolver::Solve(KnapsackInstance *instance_,
 /// \param itemNum The item currently under consideration
 void KnapsackBTSolver::findSolutions(size_t itemNum) {
 
-  // Check timeout flag
-  // We only perform time math at leaf nodes, to reduce computation
-  if (outOfTime) {
+  // If time has run out, exit early
+  if (countdown.Expired()) {
     return;
   }
 
-  // These are static so that the getters are only invoked once
-  static size_t capacity = instance->GetCapacity();
-  static uint32_t itemCount = instance->GetItemCnt();
-
-  static uint32_t weight = 0;
+  stats.Node(itemNum - 1);
 
   if (itemNum > itemCount) {
 
-    // Check if time has run out
-    if (timeSince(startTime) > maxDuration) {
-      outOfTime = true;
-      return;
-    }
+    stats.Leaf(itemNum - 1);
 
-    int32_t currentValue = currentSolution->ComputeValue();
-    int32_t bestValue = bestSolution->GetValue();
+    int64_t currentValue = currentSolution->ComputeValue();
+    int64_t bestValue = bestSolution->GetValue();
 
     if (currentValue > bestValue) {
-      bestSolution->Copy(currentSolution);
+      bestSolution->Copy(currentSolution.get());
+      stats.Improve(currentValue);
     }
     return;
   }
@@ -68,6 +78,8 @@ void KnapsackBTSolver::findSolutions(size_t itemNum) {
     findSolutions(itemNum + 1);
 
     weight -= itemWeight;
+  } else {
+    stats.CapacityPrune(itemNum);
   }
 
   currentSolution->DontTakeItem(itemNum);
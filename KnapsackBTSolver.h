@@ -11,25 +11,44 @@
 #ifndef KNAPSACKBTSOLVER_H
 #define KNAPSACKBTSOLVER_H
 
+#include "KnapsackDeadline.h"
+#include "KnapsackSearchStats.h"
+#include "KnapsackWarmStart.h"
 #include "knapsack.h"
+#include <memory>
 
 class KnapsackBTSolver {
 
   KnapsackInstance *instance;
-  KnapsackSolution *currentSolution;
+  std::unique_ptr<KnapsackSolution> currentSolution;
   KnapsackSolution *bestSolution;
-  std::chrono::high_resolution_clock::time_point startTime;
-  std::chrono::duration<double> maxDuration;
-  bool outOfTime;
+  size_t capacity;
+  uint32_t itemCount;
+  uint32_t weight;
+  KnapsackDeadline deadline;
+  KnapsackDeadline::Countdown countdown;
+  KnapsackWarmStart warmStart;
+  bool warmStarting;
+  KnapsackSearchStats stats;
 
   void findSolutions(size_t itemNum);
 
 public:
   KnapsackBTSolver()
-      : instance(nullptr), currentSolution(nullptr), bestSolution(nullptr),
-        maxDuration(std::chrono::seconds(10)), outOfTime(false) {}
+      : instance(nullptr), bestSolution(nullptr), capacity(0), itemCount(0),
+        weight(0), warmStarting(true) {}
 
   void Solve(KnapsackInstance *instance, KnapsackSolution *solution);
+
+  /// Set whether to start from a KnapsackWarmStart solution. Backtracking
+  /// does not prune by value, so this only helps when time runs out.
+  void SetWarmStart(bool enabled) { warmStarting = enabled; }
+
+  /// Get the limits on every Solve(), or cancel a running one.
+  KnapsackDeadline &GetDeadline() { return deadline; }
+
+  /// Get what the last Solve() did at each depth of the tree.
+  KnapsackSearchStats const &GetStats() const { return stats; }
 };
 
 #endif // KNAPSACKBTSOLVER_H
@@ -0,0 +1,86 @@
+//===-- KnapsackBatchSolver.h - Solve Many Instances at Once ----*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackBatchSolver class template, which solves
+/// many 0/1 knapsack problems at once on a fixed pool of threads, with one
+/// solver per thread.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKBATCHSOLVER_H
+#define KNAPSACKBATCHSOLVER_H
+
+#include "ThreadPool.h"
+#include "Time.h"
+#include "knapsack.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/// Provides solutions for many 0/1 Knapsack Problems using `Solver`, solving
+/// one instance on every thread of a pool at a time.
+///
+/// Every thread keeps its own `Solver` for the life of the batch solver, so
+/// no solver is used by two threads at once, and the buffers a solver keeps
+/// between solves (DP rows, search stacks, node pools) are allocated by the
+/// first instances each thread solves and reused by the rest. Threads take
+/// the next instance as they finish one, so uneven instances balance across
+/// the pool.
+///
+/// Solvers that use several threads themselves, such as a multi-threaded
+/// KnapsackDPSolver, still work, but share the cores with the pool.
+template <typename Solver> class KnapsackBatchSolver {
+private:
+  ThreadPool threadPool;
+  std::vector<std::unique_ptr<Solver>> solvers;
+  std::vector<double> seconds;
+
+public:
+  /// \param threadCount How many instances to solve at once
+  /// \param args The arguments every thread's `Solver` is constructed with
+  template <typename... Args>
+  explicit KnapsackBatchSolver(unsigned const threadCount,
+                               Args const &... args)
+      : threadPool(threadCount > 0 ? threadCount : 1) {
+
+    for (unsigned t = 0; t < threadPool.GetThreadCount(); ++t) {
+      solvers.emplace_back(new Solver(args...));
+    }
+  }
+
+  /// Solve every instance, writing each one's solution to the solution at
+  /// the same index. Returns once all of them are solved.
+  void Solve(std::vector<KnapsackInstance *> const &instances,
+             std::vector<KnapsackSolution *> const &solutions) {
+
+    seconds.assign(instances.size(), 0);
+    std::atomic<size_t> nextInstance(0);
+
+    threadPool.Run([&](unsigned threadNum) {
+
+      Solver &solver = *solvers[threadNum];
+
+      for (size_t i = nextInstance.fetch_add(1, std::memory_order_relaxed);
+           i < instances.size();
+           i = nextInstance.fetch_add(1, std::memory_order_relaxed)) {
+
+        auto startTime = getTime();
+        solver.Solve(instances[i], solutions[i]);
+        seconds[i] = timeSince(startTime).count();
+      }
+    });
+  }
+
+  /// Get how long each instance of the last Solve() took, in seconds, in
+  /// the order of the instances.
+  std::vector<double> const &GetSeconds() const { return seconds; }
+
+  unsigned GetThreadCount() const { return threadPool.GetThreadCount(); }
+
+  /// Get the solver of one thread, to configure it or read its statistics.
+  Solver &GetSolver(unsigned threadNum) { return *solvers[threadNum]; }
+};
+
+#endif // KNAPSACKBATCHSOLVER_H
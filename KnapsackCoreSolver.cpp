@@ -0,0 +1,199 @@
+//===-- KnapsackCoreSolver.cpp - Solve by Expanding Core ------------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackCoreSolver class, which is responsible for
+/// solving 0/1 knapsack problems by solving a core of items around the break
+/// item, and expanding the core only as far as is needed.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackCoreSolver.h"
+#include <algorithm>
+
+void KnapsackCoreSolver::Solve(KnapsackInstance *instance_,
+                               KnapsackSolution *solution_) {
+
+  instance = instance_;
+  solution = solution_;
+  capacity = instance->GetCapacity();
+
+  items.clear();
+
+  for (int i = 1; i <= instance->GetItemCnt(); ++i) {
+
+    int64_t weight = instance->GetItemWeight(i);
+    int64_t value = instance->GetItemValue(i);
+
+    if (value <= 0 || weight > capacity) {
+      // Never worth taking, or never fits
+      continue;
+    }
+    if (weight == 0) {
+      // Always worth taking
+      solution->TakeItem(i);
+      continue;
+    }
+    items.emplace_back(Item{i, weight, value});
+  }
+
+  // Sort by value / weight, comparing cross products to stay exact.
+  std::stable_sort(items.begin(), items.end(),
+                   [](Item const &a, Item const &b) {
+                     return a.value * b.weight > b.value * a.weight;
+                   });
+
+  // Find the break item, and start from the greedy solution that takes every
+  // item before it.
+  int64_t breakWeight = 0, breakValue = 0;
+
+  for (breakItem = 0; breakItem < items.size(); ++breakItem) {
+
+    if (breakWeight + items[breakItem].weight > capacity) {
+      break;
+    }
+    breakWeight += items[breakItem].weight;
+    breakValue += items[breakItem].value;
+  }
+
+  coreBegin = coreEnd = breakItem;
+  states.assign(1,
+                State{breakWeight, breakValue, KnapsackStateHistory::noNode});
+  history.Clear();
+
+  bestValue = breakValue;
+  bestNode = KnapsackStateHistory::noNode;
+
+  // Grow the core alternately after and before the break item, until no
+  // state can beat the best solution seen.
+  while (!states.empty() && (coreBegin > 0 || coreEnd < items.size())) {
+
+    if (coreEnd < items.size()) {
+      addToCore(coreEnd++);
+    }
+    if (coreBegin > 0 && !states.empty()) {
+      addToCore(--coreBegin);
+    }
+    if (history.NeedsCompaction()) {
+
+      // The best solution's nodes must survive compaction too
+      states.push_back(State{0, 0, bestNode});
+      history.Compact(states);
+      bestNode = states.back().node;
+      states.pop_back();
+    }
+  }
+
+  // The best solution is the greedy solution with the recorded core items
+  // changed.
+  std::vector<bool> changed(items.size());
+
+  history.ForEachItem(
+      bestNode, [&changed](uint32_t itemNum) { changed[itemNum] = true; });
+
+  for (size_t i = 0; i < items.size(); ++i) {
+
+    if ((i < breakItem) != changed[i]) {
+      solution->TakeItem(items[i].originalPosition);
+    }
+  }
+
+  solution->ComputeValue();
+}
+
+void KnapsackCoreSolver::addToCore(size_t itemNum) {
+
+  // Changing an item before the break item drops it, and changing one after
+  // it takes it.
+  int64_t sign = itemNum < breakItem ? -1 : 1;
+  int64_t weightChange = sign * items[itemNum].weight;
+  int64_t valueChange = sign * items[itemNum].value;
+
+  nextStates.clear();
+
+  size_t keep = 0, change = 0;
+  int64_t lastValue = INT64_MIN;
+
+  // Merge the states that keep the item with those that change it, by
+  // weight. Shifting every state by the same weight keeps them in order. A
+  // state is kept only if it is more valuable than every lighter state, since
+  // any later change applies to both alike.
+  while (keep < states.size() || change < states.size()) {
+
+    State state;
+    bool changes;
+
+    if (keep == states.size()) {
+      changes = true;
+    } else if (change == states.size()) {
+      changes = false;
+    } else {
+      int64_t changedWeight = states[change].weight + weightChange;
+      int64_t changedValue = states[change].value + valueChange;
+
+      changes = changedWeight < states[keep].weight ||
+                (changedWeight == states[keep].weight &&
+                 changedValue > states[keep].value);
+    }
+
+    if (changes) {
+      state = states[change++];
+      state.weight += weightChange;
+      state.value += valueChange;
+    } else {
+      state = states[keep++];
+    }
+
+    if (state.value <= lastValue) {
+      continue; // Dominated
+    }
+    lastValue = state.value;
+
+    if (changes) {
+      state.node = history.Add(state.node, itemNum);
+    }
+
+    if (state.weight <= capacity && state.value > bestValue) {
+      bestValue = state.value;
+      bestNode = state.node;
+    }
+
+    nextStates.push_back(state);
+  }
+
+  // Drop the states that cannot beat the best solution. The best solution
+  // itself is recorded, so it can be dropped too.
+  states.clear();
+
+  for (auto const &state : nextStates) {
+    if (upperBound(state) > bestValue) {
+      states.push_back(state);
+    }
+  }
+}
+
+int64_t KnapsackCoreSolver::upperBound(State const &state) const {
+
+  // Taking items after the core gains at most the value / weight of the first
+  // of them per unit of weight, and dropping items before the core loses at
+  // least the value / weight of the last of them. Any mix of the two does no
+  // better than the one that fixes the weight alone.
+  if (state.weight <= capacity) {
+
+    if (coreEnd == items.size()) {
+      return state.value;
+    }
+    Item const &next = items[coreEnd];
+
+    return state.value + (capacity - state.weight) * next.value / next.weight;
+  }
+
+  if (coreBegin == 0) {
+    return INT64_MIN; // Too heavy, and nothing left to drop
+  }
+  Item const &next = items[coreBegin - 1];
+  int64_t excess = state.weight - capacity;
+
+  return state.value - (excess * next.value + next.weight - 1) / next.weight;
+}
@@ -0,0 +1,82 @@
+//===-- KnapsackCoreSolver.h - Solve by Expanding Core ----------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackCoreSolver class, which is responsible for
+/// solving 0/1 knapsack problems by solving a core of items around the break
+/// item, and expanding the core only as far as is needed.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKCORESOLVER_H
+#define KNAPSACKCORESOLVER_H
+
+#include "KnapsackStateHistory.h"
+#include "knapsack.h"
+
+/// Provides a solution for a 0/1 Knapsack Problem using an expanding core, in
+/// the style of Pisinger's Minknap.
+///
+/// With the items sorted by value / weight, the greedy solution takes every
+/// item before the break item (the first one that does not fit). In an optimal
+/// solution, items far before the break item are almost always taken and
+/// items far after it almost never are, so only a small core of items around
+/// it needs to be decided. The core starts empty and grows one item at a time
+/// on each side. Its states are the (weight, value) pairs reachable by
+/// changing core items relative to the greedy solution, and states that no
+/// change outside the core could make optimal are dropped. Once no state is
+/// left, the best solution seen is optimal.
+class KnapsackCoreSolver {
+private:
+  struct Item {
+    /// Specifies the position of this item in the original item list of the
+    /// KnapsackInstance.
+    int originalPosition;
+    int64_t weight, value;
+  };
+
+  struct State {
+    int64_t weight, value;
+    /// The node in `history` recording the last core item this state changed
+    uint32_t node;
+  };
+
+  KnapsackInstance *instance = nullptr;
+  KnapsackSolution *solution = nullptr;
+  int64_t capacity = 0;
+
+  /// The items that might be taken, sorted by value / weight
+  std::vector<Item> items;
+  size_t breakItem = 0;
+  /// The core is items [coreBegin, coreEnd). Items before it are taken and
+  /// items after it are not, except where a state changed them.
+  size_t coreBegin = 0, coreEnd = 0;
+
+  std::vector<State> states, nextStates;
+  KnapsackStateHistory history;
+
+  int64_t bestValue = 0;
+  uint32_t bestNode = KnapsackStateHistory::noNode;
+
+  /// Add an item to the core. Every state may keep the item as it is or
+  /// change it: take it if it is after the break item, or drop it if it is
+  /// before.
+  void addToCore(size_t itemNum);
+
+  /// Get an upper bound on the value any state reachable from `state` by
+  /// changing items outside the core can have.
+  int64_t upperBound(State const &state) const;
+
+public:
+  /// Solve a 0/1 Knapsack Problem using an expanding core.
+  /// \param instance The 0/1 Knapsack Problem to be solved
+  /// \param [out] solution The solution to the 0/1 Knapsack Problem
+  void Solve(KnapsackInstance *instance, KnapsackSolution *solution);
+
+  /// Get the number of items the core had grown to when the last Solve()
+  /// finished.
+  size_t GetCoreSize() const { return coreEnd - coreBegin; }
+};
+
+#endif // KNAPSACKCORESOLVER_H
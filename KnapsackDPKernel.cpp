@@ -0,0 +1,275 @@
+//===-- KnapsackDPKernel.cpp - Vectorized DP row update -------------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the row update kernels shared by every mode of
+/// KnapsackDPSolver. The kernel is implemented with SSE4.1, AVX2 and AVX-512
+/// as well as in plain C++, and the fastest one the CPU supports is picked
+/// the first time the kernel is used.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackDPKernel.h"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KNAPSACK_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef void (*RowKernel)(uint32_t const *, uint32_t *, size_t, size_t, size_t,
+                          uint32_t, uint64_t *);
+
+struct Kernel {
+  RowKernel update;
+  RowKernel updateMinWeight;
+  char const *name;
+};
+
+// The kernels below are written for both kinds of row. In a weight-indexed
+// row (Minimize = false) the item shifts cells by its weight and adds its
+// value, and the larger cell wins. In a value-indexed row (Minimize = true) it
+// shifts cells by its value and adds its weight, and the smaller cell wins.
+
+/// Copy the cells in [begin, end) that are too small to hold the item.
+/// \returns The first cell that can hold the item, or `end`
+inline size_t copyCellsBelowShift(uint32_t const *previousRow,
+                                  uint32_t *nextRow, size_t begin, size_t end,
+                                  size_t shift) {
+
+  size_t firstReachable = shift < begin ? begin : shift;
+
+  if (firstReachable >= end) {
+    firstReachable = end;
+  }
+  if (firstReachable > begin) {
+    std::memcpy(nextRow + begin, previousRow + begin,
+                (firstReachable - begin) * sizeof(uint32_t));
+  }
+  return firstReachable;
+}
+
+/// Update cells [begin, end), all of which can hold the item, one at a time.
+template <bool Minimize>
+inline void updateCells(uint32_t const *previousRow, uint32_t *nextRow,
+                        size_t begin, size_t end, size_t shift,
+                        uint32_t addend, uint64_t *takenBits) {
+
+  for (size_t c = begin; c < end; ++c) {
+
+    uint32_t valueIfTaken = previousRow[c - shift] + addend;
+    uint32_t valueIfNotTaken = previousRow[c];
+    bool taken = Minimize ? valueIfTaken < valueIfNotTaken
+                          : valueIfTaken > valueIfNotTaken;
+
+    nextRow[c] = taken ? valueIfTaken : valueIfNotTaken;
+
+    if (takenBits) {
+      takenBits[c / 64] |= uint64_t(taken) << (c % 64);
+    }
+  }
+}
+
+/// Get the first cell at or after `c` that starts a group of `lanes` cells,
+/// without going past `end`.
+inline size_t alignToLanes(size_t c, size_t end, size_t lanes) {
+
+  size_t aligned = (c + lanes - 1) / lanes * lanes;
+
+  return aligned < end ? aligned : end;
+}
+
+template <bool Minimize>
+void updateRowScalar(uint32_t const *previousRow, uint32_t *nextRow,
+                     size_t begin, size_t end, size_t shift, uint32_t addend,
+                     uint64_t *takenBits) {
+
+  size_t c = copyCellsBelowShift(previousRow, nextRow, begin, end, shift);
+
+  updateCells<Minimize>(previousRow, nextRow, c, end, shift, addend,
+                        takenBits);
+}
+
+#ifdef KNAPSACK_X86_KERNELS
+
+template <bool Minimize>
+__attribute__((target("sse4.1"))) void
+updateRowSSE41(uint32_t const *previousRow, uint32_t *nextRow, size_t begin,
+               size_t end, size_t shift, uint32_t addend, uint64_t *takenBits) {
+
+  size_t c = copyCellsBelowShift(previousRow, nextRow, begin, end, shift);
+  size_t vectorBegin = alignToLanes(c, end, 4);
+
+  updateCells<Minimize>(previousRow, nextRow, c, vectorBegin, shift, addend,
+                        takenBits);
+
+  __m128i itemAddend = _mm_set1_epi32(addend);
+
+  for (c = vectorBegin; c + 4 <= end; c += 4) {
+
+    __m128i valueIfNotTaken =
+        _mm_loadu_si128((__m128i const *)(previousRow + c));
+    __m128i valueIfTaken = _mm_add_epi32(
+        _mm_loadu_si128((__m128i const *)(previousRow + c - shift)),
+        itemAddend);
+    __m128i best = Minimize ? _mm_min_epu32(valueIfTaken, valueIfNotTaken)
+                            : _mm_max_epu32(valueIfTaken, valueIfNotTaken);
+
+    _mm_storeu_si128((__m128i *)(nextRow + c), best);
+
+    if (takenBits) {
+      // A lane is taken wherever the best value is not the skipped value
+      int notTaken = _mm_movemask_ps(
+          _mm_castsi128_ps(_mm_cmpeq_epi32(best, valueIfNotTaken)));
+      takenBits[c / 64] |= uint64_t(~notTaken & 0xF) << (c % 64);
+    }
+  }
+
+  updateCells<Minimize>(previousRow, nextRow, c, end, shift, addend,
+                        takenBits);
+}
+
+template <bool Minimize>
+__attribute__((target("avx2"))) void
+updateRowAVX2(uint32_t const *previousRow, uint32_t *nextRow, size_t begin,
+              size_t end, size_t shift, uint32_t addend, uint64_t *takenBits) {
+
+  size_t c = copyCellsBelowShift(previousRow, nextRow, begin, end, shift);
+  size_t vectorBegin = alignToLanes(c, end, 8);
+
+  updateCells<Minimize>(previousRow, nextRow, c, vectorBegin, shift, addend,
+                        takenBits);
+
+  __m256i itemAddend = _mm256_set1_epi32(addend);
+
+  for (c = vectorBegin; c + 8 <= end; c += 8) {
+
+    __m256i valueIfNotTaken =
+        _mm256_loadu_si256((__m256i const *)(previousRow + c));
+    __m256i valueIfTaken = _mm256_add_epi32(
+        _mm256_loadu_si256((__m256i const *)(previousRow + c - shift)),
+        itemAddend);
+    __m256i best = Minimize ? _mm256_min_epu32(valueIfTaken, valueIfNotTaken)
+                            : _mm256_max_epu32(valueIfTaken, valueIfNotTaken);
+
+    _mm256_storeu_si256((__m256i *)(nextRow + c), best);
+
+    if (takenBits) {
+      int notTaken = _mm256_movemask_ps(
+          _mm256_castsi256_ps(_mm256_cmpeq_epi32(best, valueIfNotTaken)));
+      takenBits[c / 64] |= uint64_t(~notTaken & 0xFF) << (c % 64);
+    }
+  }
+
+  updateCells<Minimize>(previousRow, nextRow, c, end, shift, addend,
+                        takenBits);
+}
+
+template <bool Minimize>
+__attribute__((target("avx512f"))) void
+updateRowAVX512(uint32_t const *previousRow, uint32_t *nextRow, size_t begin,
+                size_t end, size_t shift, uint32_t addend,
+                uint64_t *takenBits) {
+
+  size_t c = copyCellsBelowShift(previousRow, nextRow, begin, end, shift);
+  size_t vectorBegin = alignToLanes(c, end, 16);
+
+  updateCells<Minimize>(previousRow, nextRow, c, vectorBegin, shift, addend,
+                        takenBits);
+
+  __m512i itemAddend = _mm512_set1_epi32(addend);
+
+  for (c = vectorBegin; c + 16 <= end; c += 16) {
+
+    __m512i valueIfNotTaken = _mm512_loadu_si512(previousRow + c);
+    __m512i valueIfTaken = _mm512_add_epi32(
+        _mm512_loadu_si512(previousRow + c - shift), itemAddend);
+
+    _mm512_storeu_si512(nextRow + c,
+                        Minimize
+                            ? _mm512_min_epu32(valueIfTaken, valueIfNotTaken)
+                            : _mm512_max_epu32(valueIfTaken, valueIfNotTaken));
+
+    if (takenBits) {
+      __mmask16 taken =
+          Minimize ? _mm512_cmplt_epu32_mask(valueIfTaken, valueIfNotTaken)
+                   : _mm512_cmpgt_epu32_mask(valueIfTaken, valueIfNotTaken);
+      takenBits[c / 64] |= uint64_t(taken) << (c % 64);
+    }
+  }
+
+  updateCells<Minimize>(previousRow, nextRow, c, end, shift, addend,
+                        takenBits);
+}
+
+#endif // KNAPSACK_X86_KERNELS
+
+Kernel const scalarKernel = {updateRowScalar<false>, updateRowScalar<true>,
+                             "scalar"};
+
+/// Pick the kernel to use, either the one named by KNAPSACK_DP_KERNEL or the
+/// widest one the CPU supports.
+Kernel selectKernel() {
+
+#ifdef KNAPSACK_X86_KERNELS
+  Kernel const kernels[] = {
+      {updateRowAVX512<false>, updateRowAVX512<true>, "avx512"},
+      {updateRowAVX2<false>, updateRowAVX2<true>, "avx2"},
+      {updateRowSSE41<false>, updateRowSSE41<true>, "sse4.1"},
+  };
+  bool const supported[] = {
+      __builtin_cpu_supports("avx512f") != 0,
+      __builtin_cpu_supports("avx2") != 0,
+      __builtin_cpu_supports("sse4.1") != 0,
+  };
+
+  char const *forced = std::getenv("KNAPSACK_DP_KERNEL");
+
+  if (forced != nullptr && std::strcmp(forced, scalarKernel.name) == 0) {
+    return scalarKernel;
+  }
+
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i) {
+
+    if (!supported[i]) {
+      continue;
+    }
+    if (forced == nullptr || std::strcmp(forced, kernels[i].name) == 0) {
+      return kernels[i];
+    }
+  }
+#endif
+
+  return scalarKernel;
+}
+
+Kernel const &getKernel() {
+
+  static Kernel const kernel = selectKernel();
+
+  return kernel;
+}
+
+} // namespace
+
+void dpUpdateRow(uint32_t const *previousRow, uint32_t *nextRow, size_t begin,
+                 size_t end, size_t weight, uint32_t value,
+                 uint64_t *takenBits) {
+
+  getKernel().update(previousRow, nextRow, begin, end, weight, value,
+                     takenBits);
+}
+
+void dpUpdateMinWeightRow(uint32_t const *previousRow, uint32_t *nextRow,
+                          size_t begin, size_t end, size_t value,
+                          uint32_t weight, uint64_t *takenBits) {
+
+  getKernel().updateMinWeight(previousRow, nextRow, begin, end, value, weight,
+                              takenBits);
+}
+
+char const *dpKernelName() { return getKernel().name; }
@@ -0,0 +1,57 @@
+//===-- KnapsackDPKernel.h - Vectorized DP row update -----------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the row update kernels shared by every mode of
+/// KnapsackDPSolver. The kernel is implemented with SSE4.1, AVX2 and AVX-512
+/// as well as in plain C++, and the fastest one the CPU supports is picked
+/// the first time the kernel is used.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKDPKERNEL_H
+#define KNAPSACKDPKERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+/// Compute cells [begin, end) of a DP row from the previous row.
+///
+/// For each capacity c, the new cell is the better of skipping the item
+/// (`previousRow[c]`) and taking it (`previousRow[c - weight] + value`). Only
+/// a strictly greater value counts as taking the item, which matches the
+/// backtrack in KnapsackDPSolver.
+///
+/// \param previousRow The row before this item. Must not overlap `nextRow`.
+/// \param [out] nextRow The row after this item
+/// \param begin The first cell to compute
+/// \param end One past the last cell to compute
+/// \param weight The weight of the item
+/// \param value The value of the item
+/// \param [out] takenBits If not null, bit c of this array is set for every
+/// cell c where the item is taken. Bits are only ever set, never cleared, and
+/// `begin` must be a multiple of 64.
+void dpUpdateRow(uint32_t const *previousRow, uint32_t *nextRow, size_t begin,
+                 size_t end, size_t weight, uint32_t value,
+                 uint64_t *takenBits);
+
+/// Compute cells [begin, end) of a value-indexed DP row from the previous row.
+///
+/// Each cell v holds the least weight that reaches value v. The new cell is
+/// the smaller of skipping the item (`previousRow[v]`) and taking it
+/// (`previousRow[v - value] + weight`), and only a strictly smaller weight
+/// counts as taking the item. Unreachable values must hold a weight greater
+/// than the capacity but no greater than 2^31, so that sums cannot overflow.
+///
+/// \see dpUpdateRow for the remaining parameters
+void dpUpdateMinWeightRow(uint32_t const *previousRow, uint32_t *nextRow,
+                          size_t begin, size_t end, size_t value,
+                          uint32_t weight, uint64_t *takenBits);
+
+/// Get the name of the kernel used by dpUpdateRow().
+/// The kernel can be forced by setting the environment variable
+/// KNAPSACK_DP_KERNEL to "scalar", "sse4.1", "avx2" or "avx512".
+char const *dpKernelName();
+
+#endif // KNAPSACKDPKERNEL_H
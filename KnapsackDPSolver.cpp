@@ -9,10 +9,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "KnapsackDPSolver.h"
-
-/// Get the maximum of two numbers
-/// \returns whichever number is greater
-uint32_t max(uint32_t a, uint32_t b);
+#include "KnapsackDPKernel.h"
+#include <algorithm>
 
 void KnapsackDPSolver::Solve(KnapsackInstance *instance_,
                              KnapsackSolution *solution_) {
@@ -20,6 +18,67 @@ void KnapsackDPSolver::Solve(KnapsackInstance *instance_,
   instance = instance_;
   solution = solution_;
 
+  if (threadCount > 1 && threadPool == nullptr) {
+    threadPool.reset(new ThreadPool(threadCount));
+  }
+
+  switch (mode) {
+  case DP_FULL_TABLE:
+    solveFullTable();
+    break;
+  case DP_LINEAR_MEMORY:
+    solveLinearMemory();
+    break;
+  case DP_BIT_PACKED:
+    solveBitPacked();
+    break;
+  case DP_BY_VALUE:
+    solveByValue();
+    break;
+  case DP_AUTO:
+    if (prefersValueIndex()) {
+      solveByValue();
+    } else {
+      solveBitPacked();
+    }
+    break;
+  }
+
+  solution->ComputeValue();
+}
+
+/// Rows shorter than this many cells per thread are not worth splitting.
+static size_t const minCellsPerThread = 16384;
+
+template <typename Function>
+void KnapsackDPSolver::forEachChunk(size_t cells, Function const &function) {
+
+  if (threadPool == nullptr || cells < 2 * minCellsPerThread) {
+    function(0, cells);
+    return;
+  }
+
+  size_t threads = threadPool->GetThreadCount();
+
+  if (cells / threads < minCellsPerThread) {
+    threads = cells / minCellsPerThread;
+  }
+
+  size_t chunkSize = (cells + threads - 1) / threads;
+  chunkSize = (chunkSize + 63) / 64 * 64;
+
+  threadPool->Run([&](unsigned threadNum) {
+    size_t begin = threadNum * chunkSize;
+    size_t end = begin + chunkSize < cells ? begin + chunkSize : cells;
+
+    if (begin < end) {
+      function(begin, end);
+    }
+  });
+}
+
+void KnapsackDPSolver::solveFullTable() {
+
   size_t itemCount = instance->GetItemCnt();
   size_t capacity = instance->GetCapacity();
 
@@ -38,34 +97,10 @@ void KnapsackDPSolver::Solve(KnapsackInstance *instance_,
   // The first row will always stay all 0's, (no items), so we can skip it.
   for (size_t i = 1; i <= itemCount; ++i) {
 
-    size_t itemWeight = instance->GetItemWeight(i);
-    uint32_t itemValue = instance->GetItemValue(i);
-
-    for (size_t c = 0; c <= capacity; ++c) {
-
-      // i: item number, c: capacity
-
-      if (c < itemWeight) {
-
-        // Cannot take the item - solution is the same as the row above.
-        solutionTable[i][c] = solutionTable[i - 1][c];
-
-      } else {
-
-        // Calculate remaining capacity and value if this item is taken
-        size_t remainingCapacity = c - itemWeight;
-
-        uint32_t remainingValue = solutionTable[i - 1][remainingCapacity];
-
-        uint32_t valueIfTaken = itemValue + remainingValue;
-
-        // If not taken, the value will be the same as the row above.
-        uint32_t valueIfNotTaken = solutionTable[i - 1][c];
-
-        // Take whichever value is greater
-        solutionTable[i][c] = max(valueIfTaken, valueIfNotTaken);
-      }
-    }
+    // Each cell is the better of skipping the item (the cell above) and
+    // taking it (the cell above and itemWeight to the left, plus itemValue).
+    updateRow(solutionTable[i - 1].data(), solutionTable[i].data(),
+              capacity + 1, i, nullptr);
   }
   // The table of all optimal solutions is built.
   // The value at solutionTable[itemCount][capacity] is the optimal value for
@@ -91,8 +126,208 @@ void KnapsackDPSolver::Solve(KnapsackInstance *instance_,
       c -= instance->GetItemWeight(i);
     }
   }
+}
 
-  solution->ComputeValue();
+void KnapsackDPSolver::solveLinearMemory() {
+
+  size_t itemCount = instance->GetItemCnt();
+  size_t capacity = instance->GetCapacity();
+
+  if (itemCount == 0) {
+    return;
+  }
+
+  valueRow.resize(capacity + 1);
+  nextValueRow.resize(capacity + 1);
+  originRow.resize(capacity + 1);
+  nextOriginRow.resize(capacity + 1);
+  decisionRow.resize((capacity + 64) / 64);
+
+  recoverItems(1, itemCount, capacity);
 }
 
-uint32_t max(uint32_t a, uint32_t b) { return a > b ? a : b; }
+/// Find the items that the full-table backtrack would take from items
+/// firstItem..lastItem, when those items alone are packed into `capacity`.
+///
+/// The items are split in half. One forward pass over the whole range
+/// computes the last row of the table, and while passing over the upper half
+/// each cell also remembers which cell of the middle row the backtrack would
+/// reach from it. That tells us how the capacity is divided between the two
+/// halves, and each half is then solved on its own.
+void KnapsackDPSolver::recoverItems(size_t firstItem, size_t lastItem,
+                                    size_t capacity) {
+
+  if (firstItem == lastItem) {
+
+    // A single item is taken if it fits and adds any value at all.
+    if ((size_t)instance->GetItemWeight(firstItem) <= capacity &&
+        instance->GetItemValue(firstItem) > 0) {
+      solution->TakeItem(firstItem);
+    }
+    return;
+  }
+
+  size_t middleItem = firstItem + (lastItem - firstItem) / 2;
+  size_t cells = capacity + 1;
+
+  std::fill(valueRow.begin(), valueRow.begin() + cells, 0);
+
+  for (size_t i = firstItem; i <= middleItem; ++i) {
+
+    updateRow(valueRow.data(), nextValueRow.data(), cells, i, nullptr);
+    valueRow.swap(nextValueRow);
+  }
+
+  // Every cell of the middle row is its own origin.
+  for (size_t c = 0; c < cells; ++c) {
+    originRow[c] = c;
+  }
+
+  for (size_t i = middleItem + 1; i <= lastItem; ++i) {
+
+    size_t itemWeight = instance->GetItemWeight(i);
+
+    std::fill(decisionRow.begin(), decisionRow.begin() + (cells + 63) / 64, 0);
+
+    updateRow(valueRow.data(), nextValueRow.data(), cells, i,
+              decisionRow.data());
+    valueRow.swap(nextValueRow);
+
+    // A cell where the item was taken has the origin of the cell it was
+    // taken from; any other cell keeps its own.
+    forEachChunk(cells, [&](size_t begin, size_t end) {
+      for (size_t c = begin; c < end; ++c) {
+
+        bool taken = decisionRow[c / 64] >> (c % 64) & 1;
+
+        nextOriginRow[c] = taken ? originRow[c - itemWeight] : originRow[c];
+      }
+    });
+    originRow.swap(nextOriginRow);
+  }
+
+  // The capacity left over for the lower half once the backtrack has walked
+  // through the upper half.
+  size_t lowerCapacity = originRow[capacity];
+
+  recoverItems(middleItem + 1, lastItem, capacity - lowerCapacity);
+  recoverItems(firstItem, middleItem, lowerCapacity);
+}
+
+void KnapsackDPSolver::solveBitPacked() {
+
+  size_t itemCount = instance->GetItemCnt();
+  size_t capacity = instance->GetCapacity();
+
+  // Two rows of values, the previous one and the one being computed. Only
+  // the take/skip decisions are kept for every row.
+  valueRow.assign(capacity + 1, 0);
+  nextValueRow.resize(capacity + 1);
+
+  wordsPerRow = (capacity + 64) / 64;
+  takenBits.assign((itemCount + 1) * wordsPerRow, 0);
+
+  for (size_t i = 1; i <= itemCount; ++i) {
+
+    updateRow(valueRow.data(), nextValueRow.data(), capacity + 1, i,
+              &takenBits[i * wordsPerRow]);
+    valueRow.swap(nextValueRow);
+  }
+
+  // Walk back through the decisions, exactly as the full table is walked.
+  size_t c = capacity;
+
+  for (size_t i = itemCount; i > 0; --i) {
+
+    uint64_t const *row = &takenBits[i * wordsPerRow];
+
+    if (row[c / 64] >> (c % 64) & 1) {
+
+      solution->TakeItem(i);
+
+      c -= instance->GetItemWeight(i);
+    }
+  }
+}
+
+void KnapsackDPSolver::solveByValue() {
+
+  size_t itemCount = instance->GetItemCnt();
+  size_t capacity = instance->GetCapacity();
+  size_t valueSum = instance->GetValueSum();
+
+  // Here each cell v holds the least weight that reaches value v. Values that
+  // cannot be reached yet hold a weight one above the capacity.
+  size_t cells = valueSum + 1;
+  uint32_t unreachable = capacity + 1;
+
+  valueRow.assign(cells, unreachable);
+  valueRow[0] = 0;
+  nextValueRow.resize(cells);
+
+  wordsPerRow = (cells + 63) / 64;
+  takenBits.assign((itemCount + 1) * wordsPerRow, 0);
+
+  for (size_t i = 1; i <= itemCount; ++i) {
+
+    updateMinWeightRow(valueRow.data(), nextValueRow.data(), cells, i,
+                       &takenBits[i * wordsPerRow]);
+    valueRow.swap(nextValueRow);
+  }
+
+  // The optimal value is the highest one whose weight fits.
+  size_t v = cells - 1;
+
+  while (valueRow[v] > capacity) {
+    --v;
+  }
+
+  // Walk back through the decisions, stepping down by value.
+  for (size_t i = itemCount; i > 0; --i) {
+
+    uint64_t const *row = &takenBits[i * wordsPerRow];
+
+    if (row[v / 64] >> (v % 64) & 1) {
+
+      solution->TakeItem(i);
+
+      v -= instance->GetItemValue(i);
+    }
+  }
+}
+
+bool KnapsackDPSolver::prefersValueIndex() {
+
+  int64_t valueSum = instance->GetValueSum();
+
+  // Both tables have one bit per cell per item, and the row of one has
+  // Capacity+1 cells while the row of the other has ValueSum+1.
+  return valueSum < instance->GetCapacity();
+}
+
+void KnapsackDPSolver::updateRow(uint32_t const *previousRow,
+                                 uint32_t *nextRow, size_t cells,
+                                 size_t itemNum, uint64_t *takenBits) {
+
+  size_t itemWeight = instance->GetItemWeight(itemNum);
+  uint32_t itemValue = instance->GetItemValue(itemNum);
+
+  forEachChunk(cells, [&](size_t begin, size_t end) {
+    dpUpdateRow(previousRow, nextRow, begin, end, itemWeight, itemValue,
+                takenBits);
+  });
+}
+
+void KnapsackDPSolver::updateMinWeightRow(uint32_t const *previousRow,
+                                          uint32_t *nextRow, size_t cells,
+                                          size_t itemNum,
+                                          uint64_t *takenBits) {
+
+  size_t itemValue = instance->GetItemValue(itemNum);
+  uint32_t itemWeight = instance->GetItemWeight(itemNum);
+
+  forEachChunk(cells, [&](size_t begin, size_t end) {
+    dpUpdateMinWeightRow(previousRow, nextRow, begin, end, itemValue,
+                         itemWeight, takenBits);
+  });
+}
@@ -11,17 +11,76 @@
 #ifndef KNAPSACKDPSOLVER_H
 #define KNAPSACKDPSOLVER_H
 
+#include "ThreadPool.h"
 #include "knapsack.h"
+#include <memory>
 
 /// Provides a solution for a 0/1 Knapsack Problem, using Dynamic Programming.
 ///
 class KnapsackDPSolver {
 private:
+  DP_MODE const mode;
+  unsigned const threadCount;
   KnapsackInstance *instance;
   KnapsackSolution *solution;
 
+  // Created by the first parallel Solve() and kept for later ones, so that
+  // no threads are started per row or per instance.
+  std::unique_ptr<ThreadPool> threadPool;
+
+  // The previous row of values and the row being computed from it. Used by
+  // DP_LINEAR_MEMORY and DP_BIT_PACKED.
+  std::vector<uint32_t> valueRow;
+  std::vector<uint32_t> nextValueRow;
+
+  // Used by DP_LINEAR_MEMORY. All rows are Capacity+1 cells long and are
+  // reused by every level of the recursion in recoverItems().
+  std::vector<uint32_t> originRow;
+  std::vector<uint32_t> nextOriginRow;
+  std::vector<uint64_t> decisionRow;
+
+  // Used by DP_BIT_PACKED and DP_BY_VALUE. Row i of the matrix holds one bit
+  // per cell, set if item i is taken at that cell. Rows are `wordsPerRow` words
+  // long and are stored back to back.
+  std::vector<uint64_t> takenBits;
+  size_t wordsPerRow = 0;
+
+  void solveFullTable();
+  void solveLinearMemory();
+  void solveBitPacked();
+  void solveByValue();
+
+  /// Decide whether a value-indexed table would be smaller than a
+  /// weight-indexed one for the current instance.
+  bool prefersValueIndex();
+  void recoverItems(size_t firstItem, size_t lastItem, size_t capacity);
+
+  /// Compute the first `cells` cells of the row for item `itemNum`.
+  /// \see dpUpdateRow
+  void updateRow(uint32_t const *previousRow, uint32_t *nextRow, size_t cells,
+                 size_t itemNum, uint64_t *takenBits);
+
+  /// Compute the first `cells` cells of the value-indexed row for item
+  /// `itemNum`.
+  /// \see dpUpdateMinWeightRow
+  void updateMinWeightRow(uint32_t const *previousRow, uint32_t *nextRow,
+                          size_t cells, size_t itemNum, uint64_t *takenBits);
+
+  /// Split cells [0, cells) into one chunk per thread, and call
+  /// `function(begin, end)` for every chunk in parallel. Chunks start on
+  /// multiples of 64, so that no two threads write the same word of bits.
+  template <typename Function>
+  void forEachChunk(size_t cells, Function const &function);
+
 public:
-  KnapsackDPSolver() : instance(nullptr), solution(nullptr) {}
+  /// \param mode How the table is stored
+  /// \param threadCount How many threads compute each row. Every row depends
+  /// only on the row before it, so its cells are split between the threads
+  /// and the threads wait for each other once per item.
+  explicit KnapsackDPSolver(DP_MODE const mode = DP_FULL_TABLE,
+                            unsigned const threadCount = 1)
+      : mode(mode), threadCount(threadCount), instance(nullptr),
+        solution(nullptr) {}
 
   /// Solve a 0/1 Knapsack Problem using Dynamic Programming.
   /// \param instance The 0/1 Knapsack Problem to be solved
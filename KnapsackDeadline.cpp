@@ -0,0 +1,44 @@
+//===-- KnapsackDeadline.cpp - Time and Node Budgets for Searches ---------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackDeadline class, which stops the tree
+/// searching solvers when their time or node budget runs out or they are
+/// cancelled, and the KnapsackAnytimeResult a search under a budget returns.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackDeadline.h"
+#include <algorithm>
+
+uint32_t const KnapsackDeadline::checkInterval;
+
+void KnapsackDeadline::Start() {
+  nodeCount.store(0, std::memory_order_relaxed);
+  stopped.store(false, std::memory_order_relaxed);
+  startTime = getTime();
+}
+
+uint32_t KnapsackDeadline::check(uint64_t nodes) {
+
+  uint64_t total =
+      nodeCount.fetch_add(nodes, std::memory_order_relaxed) + nodes;
+
+  if (stopped.load(std::memory_order_relaxed)) {
+    return 0;
+  }
+
+  if ((budget.nodes != 0 && total > budget.nodes) ||
+      timeSince(startTime) > budget.time) {
+    stopped.store(true, std::memory_order_relaxed);
+    return 0;
+  }
+
+  // Check again at the first node past the budget, if that is sooner
+  if (budget.nodes != 0) {
+    return (uint32_t)std::min<uint64_t>(checkInterval,
+                                        budget.nodes - total + 1);
+  }
+  return checkInterval;
+}
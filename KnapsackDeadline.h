@@ -0,0 +1,126 @@
+//===-- KnapsackDeadline.h - Time and Node Budgets for Searches -*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackDeadline class, which stops the tree
+/// searching solvers when their time or node budget runs out or they are
+/// cancelled, and the KnapsackAnytimeResult a search under a budget returns.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKDEADLINE_H
+#define KNAPSACKDEADLINE_H
+
+#include "Time.h"
+#include <atomic>
+#include <cstdint>
+
+/// The limits on one solve.
+struct KnapsackBudget {
+  std::chrono::duration<double> time = std::chrono::seconds(10);
+  /// The most nodes to expand, or 0 for no limit
+  uint64_t nodes = 0;
+};
+
+/// What a search under a budget found: the best solution's value, and the
+/// least upper bound on the optimum the search proved. The two are equal if
+/// the search finished.
+struct KnapsackAnytimeResult {
+  int64_t value;
+  int64_t upperBound;
+  /// Whether the budget ran out, or the search was cancelled
+  bool stopped;
+  uint64_t nodes;
+  double seconds;
+
+  /// Get how far the value may be from the optimum, as a fraction of the
+  /// upper bound.
+  double GetGap() const {
+    return upperBound > 0 ? (double)(upperBound - value) / upperBound : 0;
+  }
+};
+
+/// Tells a search when to stop: once its time or node budget is spent, or
+/// once Cancel() is called, which any thread may do.
+///
+/// Reading the clock costs about as much as expanding a node, so a search
+/// asks a Countdown at every node instead, which only checks the deadline
+/// every checkInterval nodes. Searches on several threads share one deadline
+/// and use a Countdown each.
+class KnapsackDeadline {
+private:
+  KnapsackBudget budget;
+  std::chrono::high_resolution_clock::time_point startTime;
+  std::atomic<uint64_t> nodeCount{0};
+  std::atomic<bool> stopped{false};
+
+  /// Count `nodes` more nodes, and check the budget and the clock.
+  /// \return The number of nodes until the next check, or 0 to stop
+  uint32_t check(uint64_t nodes);
+
+public:
+  static uint32_t const checkInterval = 1024;
+
+  /// Counts down the nodes of one thread's search to the next check of the
+  /// deadline.
+  class Countdown {
+  private:
+    KnapsackDeadline *deadline = nullptr;
+    uint32_t interval = 1, left = 1;
+
+  public:
+    /// Start counting for a deadline that has just been started.
+    void Reset(KnapsackDeadline &deadline_) {
+      deadline = &deadline_;
+      interval = left = deadline->check(0);
+      if (left == 0) {
+        interval = left = 1;
+      }
+    }
+
+    /// Count a node.
+    /// \return Whether the search must stop
+    bool Expired() {
+      if (--left != 0) {
+        return false;
+      }
+      interval = left = deadline->check(interval);
+      if (left == 0) {
+        // Stay expired, checking at every node from now on
+        interval = left = 1;
+        return true;
+      }
+      return false;
+    }
+  };
+
+  KnapsackBudget const &GetBudget() const { return budget; }
+  void SetBudget(KnapsackBudget const &budget_) { budget = budget_; }
+
+  void SetTimeLimit(std::chrono::duration<double> time) { budget.time = time; }
+
+  /// Set the most nodes to expand, or 0 for no limit.
+  void SetNodeLimit(uint64_t nodes) { budget.nodes = nodes; }
+
+  /// Start the clock and the node count for a new search.
+  void Start();
+
+  /// Stop the running search as soon as it next checks the deadline.
+  void Cancel() { stopped.store(true, std::memory_order_relaxed); }
+
+  /// Get whether the search has been told to stop. Unlike a Countdown, this
+  /// only reads a flag, and never the clock.
+  bool IsExpired() const { return stopped.load(std::memory_order_relaxed); }
+
+  /// Get the time since Start(), in seconds.
+  double GetSeconds() const { return timeSince(startTime).count(); }
+
+  /// Get the number of nodes counted so far, up to the last check of each
+  /// Countdown.
+  uint64_t GetNodeCount() const {
+    return nodeCount.load(std::memory_order_relaxed);
+  }
+};
+
+#endif // KNAPSACKDEADLINE_H
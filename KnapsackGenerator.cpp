@@ -0,0 +1,188 @@
+//===-- KnapsackGenerator.cpp - Reproducible Instance Generator -----------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackGenerator class, which is responsible for
+/// filling 0/1 knapsack problems with random items from Pisinger's instance
+/// classes, the same way on every platform and with any number of threads.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackGenerator.h"
+#include <algorithm>
+
+/// The counters of the spanner items, kept apart from those of the items
+static uint64_t const spannerCounters = uint64_t(1) << 60;
+
+/// The largest number of draws an item makes
+static unsigned const drawsPerItem = 4;
+
+/// The divisor IC_PROFIT_CEILING rounds weights up to a multiple of
+static int64_t const ceilingDivisor = 3;
+
+uint64_t KnapsackGenerator::random(uint64_t counter, unsigned draw) const {
+
+  // The SplitMix64 output function, applied to the counter's position in
+  // the sequence SplitMix64 would step through from the seed
+  uint64_t z =
+      seed + (counter * drawsPerItem + draw + 1) * 0x9E3779B97F4A7C15ull;
+
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+int64_t KnapsackGenerator::uniform(uint64_t counter, unsigned draw,
+                                   int64_t low, int64_t high) const {
+
+  // Scale by a multiply rather than a modulo, which is both faster and
+  // nearly free of bias.
+  uint64_t span = high - low + 1;
+
+  return low + (int64_t)((unsigned __int128)random(counter, draw) * span >> 64);
+}
+
+void KnapsackGenerator::drawItem(INSTANCE_CLASS itemClass, uint64_t counter,
+                                 int64_t &weight, int64_t &value) const {
+
+  int64_t tenth = range / 10;
+
+  switch (itemClass) {
+  case IC_UNCORRELATED:
+    weight = uniform(counter, 0, 1, range);
+    value = uniform(counter, 1, 1, range);
+    break;
+  case IC_WEAKLY_CORRELATED:
+    weight = uniform(counter, 0, 1, range);
+    value = uniform(counter, 1, std::max<int64_t>(weight - tenth, 1),
+                    weight + tenth);
+    break;
+  case IC_INVERSE_STRONGLY_CORRELATED:
+    value = uniform(counter, 1, 1, range);
+    weight = value + tenth;
+    break;
+  case IC_ALMOST_STRONGLY_CORRELATED:
+    weight = uniform(counter, 0, 1, range);
+    value = uniform(counter, 1, weight + tenth - range / 500,
+                    weight + tenth + range / 500);
+    break;
+  case IC_SUBSET_SUM:
+    weight = uniform(counter, 0, 1, range);
+    value = weight;
+    break;
+  case IC_PROFIT_CEILING:
+    weight = uniform(counter, 0, 1, range);
+    value = (weight + ceilingDivisor - 1) / ceilingDivisor * ceilingDivisor;
+    break;
+  case IC_STRONGLY_CORRELATED:
+  case IC_SPANNER:
+    weight = uniform(counter, 0, 1, range);
+    value = weight + tenth;
+    break;
+  }
+}
+
+void KnapsackGenerator::SetSpanner(INSTANCE_CLASS itemClass, unsigned size,
+                                   unsigned multiplier) {
+  spannerClass = itemClass;
+  spannerSize = size > 0 ? size : 1;
+  spannerMultiplier = multiplier > 0 ? multiplier : 1;
+}
+
+template <typename T>
+void KnapsackGenerator::Generate(BasicKnapsackInstance<T> *instance) {
+
+  size_t itemCount = instance->GetItemCnt();
+
+  // The spanner items are scaled down so that their multiples span about
+  // the same weights as the other classes.
+  if (instanceClass == IC_SPANNER) {
+
+    spannerWeights.resize(spannerSize);
+    spannerValues.resize(spannerSize);
+
+    for (unsigned k = 0; k < spannerSize; ++k) {
+
+      int64_t weight, value;
+      drawItem(spannerClass, spannerCounters + k, weight, value);
+
+      spannerWeights[k] = (2 * weight + spannerMultiplier - 1) /
+                          spannerMultiplier;
+      spannerValues[k] = (2 * value + spannerMultiplier - 1) /
+                         spannerMultiplier;
+    }
+  }
+
+  std::vector<int64_t> weightSums(threadCount);
+  size_t chunk = (itemCount + threadCount - 1) / threadCount;
+
+  auto fill = [&](unsigned threadNum) {
+
+    size_t end = std::min(itemCount, (threadNum + 1) * chunk);
+    int64_t weightSum = 0;
+
+    for (size_t i = threadNum * chunk; i < end; ++i) {
+
+      int64_t weight, value;
+
+      if (instanceClass == IC_SPANNER) {
+        size_t k = uniform(i, 2, 0, spannerSize - 1);
+        int64_t multiplier = uniform(i, 3, 1, spannerMultiplier);
+
+        weight = multiplier * spannerWeights[k];
+        value = multiplier * spannerValues[k];
+      } else {
+        drawItem(instanceClass, i, weight, value);
+      }
+
+      instance->SetItem(i + 1, weight, value);
+      weightSum += weight;
+    }
+    weightSums[threadNum] = weightSum;
+  };
+
+  if (threadCount == 1) {
+    fill(0);
+  } else {
+    if (threadPool == nullptr) {
+      threadPool.reset(new ThreadPool(threadCount));
+    }
+    threadPool->Run(fill);
+  }
+
+  int64_t weightSum = 0;
+
+  for (int64_t sum : weightSums) {
+    weightSum += sum;
+  }
+
+  instance->SetCapacity((int64_t)(capacityFraction * weightSum));
+}
+
+char const *instanceClassName(INSTANCE_CLASS instanceClass) {
+
+  switch (instanceClass) {
+  case IC_UNCORRELATED:
+    return "uncorrelated";
+  case IC_WEAKLY_CORRELATED:
+    return "weakly-correlated";
+  case IC_STRONGLY_CORRELATED:
+    return "strongly-correlated";
+  case IC_INVERSE_STRONGLY_CORRELATED:
+    return "inverse-strongly-correlated";
+  case IC_ALMOST_STRONGLY_CORRELATED:
+    return "almost-strongly-correlated";
+  case IC_SUBSET_SUM:
+    return "subset-sum";
+  case IC_SPANNER:
+    return "spanner";
+  case IC_PROFIT_CEILING:
+    return "profit-ceiling";
+  }
+  return "unknown";
+}
+
+template void KnapsackGenerator::Generate(BasicKnapsackInstance<int16_t> *);
+template void KnapsackGenerator::Generate(BasicKnapsackInstance<int32_t> *);
+template void KnapsackGenerator::Generate(BasicKnapsackInstance<int64_t> *);
@@ -0,0 +1,87 @@
+//===-- KnapsackGenerator.h - Reproducible Instance Generator ---*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackGenerator class, which is responsible for
+/// filling 0/1 knapsack problems with random items from Pisinger's instance
+/// classes, the same way on every platform and with any number of threads.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKGENERATOR_H
+#define KNAPSACKGENERATOR_H
+
+#include "ThreadPool.h"
+#include "knapsack.h"
+#include <memory>
+
+/// Generates 0/1 Knapsack Problems of an INSTANCE_CLASS.
+///
+/// Every random number is a hash of the seed and a counter naming the item
+/// and the draw, in the manner of SplitMix64, rather than the next output of
+/// a stateful generator. An instance therefore depends only on its class,
+/// parameters, seed and size, and the items can be split between threads in
+/// any way.
+///
+/// The capacity is a fraction of the total weight. IC_STRONGLY_CORRELATED
+/// with R = 100 and a fraction of 1/2 is the family
+/// KnapsackInstance::Generate() draws from.
+class KnapsackGenerator {
+private:
+  INSTANCE_CLASS const instanceClass;
+  unsigned const threadCount;
+  std::unique_ptr<ThreadPool> threadPool;
+
+  uint64_t seed = 0;
+  int64_t range = 1000;
+  double capacityFraction = 0.5;
+
+  // Used for IC_SPANNER
+  INSTANCE_CLASS spannerClass = IC_STRONGLY_CORRELATED;
+  unsigned spannerSize = 2;
+  unsigned spannerMultiplier = 10;
+  std::vector<int64_t> spannerWeights, spannerValues;
+
+  /// Get random number `draw` of item `counter`.
+  uint64_t random(uint64_t counter, unsigned draw) const;
+
+  /// Get a random number from [low, high] for draw `draw` of item `counter`.
+  int64_t uniform(uint64_t counter, unsigned draw, int64_t low,
+                  int64_t high) const;
+
+  /// Draw the weight and value of an item of any class but IC_SPANNER.
+  void drawItem(INSTANCE_CLASS itemClass, uint64_t counter, int64_t &weight,
+                int64_t &value) const;
+
+public:
+  /// \param instanceClass The class of instances to generate
+  /// \param threadCount How many threads fill each instance
+  explicit KnapsackGenerator(INSTANCE_CLASS const instanceClass,
+                             unsigned const threadCount = 1)
+      : instanceClass(instanceClass),
+        threadCount(threadCount > 0 ? threadCount : 1) {}
+
+  void SetSeed(uint64_t seed_) { seed = seed_; }
+
+  /// Set R, the largest weight drawn. Every value must fit in the instance's
+  /// numbers, and the largest are about 1.1 R.
+  void SetRange(int64_t range_) { range = range_ > 0 ? range_ : 1; }
+
+  /// Set the capacity, as a fraction of the total weight of the items.
+  void SetCapacityFraction(double fraction) { capacityFraction = fraction; }
+
+  /// Set how IC_SPANNER instances are made: `size` items are drawn from
+  /// `itemClass`, then each item is one of them times a number from
+  /// [1, multiplier].
+  void SetSpanner(INSTANCE_CLASS itemClass, unsigned size,
+                  unsigned multiplier);
+
+  /// Fill an instance with random items and set its capacity.
+  template <typename T> void Generate(BasicKnapsackInstance<T> *instance);
+};
+
+/// Get the name of an instance class, such as "strongly-correlated".
+char const *instanceClassName(INSTANCE_CLASS instanceClass);
+
+#endif // KNAPSACKGENERATOR_H
@@ -0,0 +1,109 @@
+//===-- KnapsackIncrementalDPSolver.cpp - DP as Items Arrive --------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackIncrementalDPSolver class, which keeps a
+/// dynamic programming solution up to date as items are added to a 0/1
+/// knapsack problem one at a time.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackIncrementalDPSolver.h"
+#include "KnapsackDPKernel.h"
+
+void KnapsackIncrementalDPSolver::Reset(size_t capacity_) {
+  capacity = capacity_;
+  weights.clear();
+  values.clear();
+
+  valueRow.assign(capacity + 1, 0);
+  nextValueRow.resize(capacity + 1);
+
+  wordsPerRow = (capacity + 64) / 64;
+  takenBits.clear();
+}
+
+void KnapsackIncrementalDPSolver::AddItem(uint32_t weight, uint32_t value) {
+
+  weights.push_back(weight);
+  values.push_back(value);
+  takenBits.resize(takenBits.size() + wordsPerRow);
+
+  // An item heavier than the knapsack leaves the row as it was
+  if (weight > capacity) {
+    return;
+  }
+
+  dpUpdateRow(valueRow.data(), nextValueRow.data(), 0, capacity + 1, weight,
+              value, &takenBits[takenBits.size() - wordsPerRow]);
+  valueRow.swap(nextValueRow);
+}
+
+std::vector<int> KnapsackIncrementalDPSolver::GetTakenItems() const {
+
+  std::vector<int> takenItems;
+  size_t remainingCapacity = capacity;
+
+  // Walk the rows back from the last item, as in DP_BIT_PACKED
+  for (size_t i = weights.size(); i >= 1; --i) {
+    uint64_t const *row = &takenBits[(i - 1) * wordsPerRow];
+
+    if (row[remainingCapacity / 64] >> remainingCapacity % 64 & 1) {
+      takenItems.push_back(i);
+      remainingCapacity -= weights[i - 1];
+    }
+  }
+
+  return std::vector<int>(takenItems.rbegin(), takenItems.rend());
+}
+
+void KnapsackIncrementalDPSolver::GetSolution(
+    KnapsackSolution *solution) const {
+
+  std::vector<int> takenItems = GetTakenItems();
+  size_t next = 0;
+
+  for (int itemNum = 1; itemNum <= GetItemCnt(); ++itemNum) {
+    if (next < takenItems.size() && takenItems[next] == itemNum) {
+      solution->TakeItem(itemNum);
+      ++next;
+    } else {
+      solution->DontTakeItem(itemNum);
+    }
+  }
+}
+
+bool KnapsackIncrementalDPSolver::isPrefixOf(
+    KnapsackInstance const &instance) const {
+
+  if ((size_t)instance.GetCapacity() != capacity ||
+      (size_t)instance.GetItemCnt() < weights.size()) {
+    return false;
+  }
+
+  auto instanceWeights = instance.GetWeights();
+  auto instanceValues = instance.GetValues();
+
+  for (size_t i = 0; i < weights.size(); ++i) {
+    if ((uint32_t)instanceWeights[i] != weights[i] ||
+        (uint32_t)instanceValues[i] != values[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void KnapsackIncrementalDPSolver::Solve(KnapsackInstance *instance,
+                                        KnapsackSolution *solution) {
+
+  if (!isPrefixOf(*instance)) {
+    Reset(instance->GetCapacity());
+  }
+
+  for (int i = GetItemCnt() + 1; i <= instance->GetItemCnt(); ++i) {
+    AddItem(instance->GetItemWeight(i), instance->GetItemValue(i));
+  }
+
+  GetSolution(solution);
+}
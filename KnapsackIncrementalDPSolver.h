@@ -0,0 +1,79 @@
+//===-- KnapsackIncrementalDPSolver.h - DP as Items Arrive ------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackIncrementalDPSolver class, which keeps a
+/// dynamic programming solution up to date as items are added to a 0/1
+/// knapsack problem one at a time.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKINCREMENTALDPSOLVER_H
+#define KNAPSACKINCREMENTALDPSOLVER_H
+
+#include "knapsack.h"
+#include <vector>
+
+/// Provides solutions for a 0/1 Knapsack Problem whose items arrive over
+/// time, without solving it again from the start as each one arrives.
+///
+/// It keeps the last row of the weight-indexed table, which holds the
+/// optimum of the items so far at every capacity, and one bit per cell for
+/// every item, as in DP_BIT_PACKED. Adding an item computes one more row,
+/// in O(C) time, and the optimum is then the row's last cell. The items of
+/// the optimal solution are found on demand by walking the bits back, in
+/// O(n) time. The bits take n (C + 1) / 8 bytes.
+class KnapsackIncrementalDPSolver {
+private:
+  size_t capacity = 0;
+  std::vector<uint32_t> weights, values;
+
+  // The row of the items so far, and the row being computed from it
+  std::vector<uint32_t> valueRow;
+  std::vector<uint32_t> nextValueRow;
+
+  // Row i-1 holds the bits of item i, `wordsPerRow` words long. Rows are
+  // stored back to back.
+  std::vector<uint64_t> takenBits;
+  size_t wordsPerRow = 1;
+
+  /// Whether the items so far are the first items of `instance`, and the
+  /// capacities match.
+  bool isPrefixOf(KnapsackInstance const &instance) const;
+
+public:
+  explicit KnapsackIncrementalDPSolver(size_t capacity = 0) {
+    Reset(capacity);
+  }
+
+  /// Drop every item, and start again with a new capacity.
+  void Reset(size_t capacity);
+
+  /// Add an item to the problem, numbered one more than the last.
+  void AddItem(uint32_t weight, uint32_t value);
+
+  int GetItemCnt() const { return weights.size(); }
+  size_t GetCapacity() const { return capacity; }
+
+  /// Get the optimum of the items so far.
+  uint32_t GetValue() const { return valueRow[capacity]; }
+
+  /// Get the numbers of the items an optimal solution takes, in increasing
+  /// order.
+  std::vector<int> GetTakenItems() const;
+
+  /// Write the optimal solution of the items so far to a solution of an
+  /// instance whose first items they are. Its later items are left as they
+  /// are.
+  void GetSolution(KnapsackSolution *solution) const;
+
+  /// Solve a 0/1 Knapsack Problem. If it has the same capacity as the items
+  /// so far, and they are its first items, only its later items are added.
+  /// Otherwise it is solved from the start.
+  /// \param instance The 0/1 Knapsack Problem to be solved
+  /// \param [out] solution The solution to the 0/1 Knapsack Problem
+  void Solve(KnapsackInstance *instance, KnapsackSolution *solution);
+};
+
+#endif // KNAPSACKINCREMENTALDPSOLVER_H
@@ -0,0 +1,511 @@
+//===-- KnapsackInstanceFile.cpp - Read and Write Instances ---------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackInstanceFile class, which is responsible
+/// for reading 0/1 knapsack problems from files, and for writing them in a
+/// binary format that is read without copying.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackInstanceFile.h"
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/// The header of the binary format
+struct BinaryHeader {
+  char magic[8];
+  /// Also tells the byte order: it reads as binaryVersion only in the byte
+  /// order the file was written in.
+  uint32_t version;
+  /// The size of each weight and value, in bytes
+  uint32_t numberSize;
+  uint64_t itemCount;
+  int64_t capacity;
+  /// Where each array starts, in bytes from the start of the file
+  uint64_t weightsOffset, valuesOffset;
+  uint64_t reserved[2];
+};
+
+static_assert(sizeof(BinaryHeader) == 64, "the header fills a cache line");
+
+char const binaryMagic[8] = {'K', 'N', 'A', 'P', 'S', 'A', 'C', 'K'};
+uint32_t const binaryVersion = 1;
+size_t const cacheLine = 64;
+
+/// The bytes an array of `count` numbers of `size` bytes takes, padded to
+/// whole cache lines.
+uint64_t paddedSize(uint64_t count, size_t size) {
+  return (count * size + cacheLine - 1) / cacheLine * cacheLine;
+}
+
+/// Map a whole file into memory. The mapping is private, so the instance may
+/// change its items without changing the file.
+/// \return The mapping, which unmaps itself when released, or null
+std::shared_ptr<void> mapFile(std::string const &path, size_t &size,
+                              std::string &error) {
+
+  int fd = open(path.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+    error = path + ": " + strerror(errno);
+    return nullptr;
+  }
+
+  struct stat status;
+
+  if (fstat(fd, &status) != 0) {
+    error = path + ": " + strerror(errno);
+    close(fd);
+    return nullptr;
+  }
+  if (status.st_size == 0) {
+    error = path + ": empty file";
+    close(fd);
+    return nullptr;
+  }
+
+  size = status.st_size;
+
+  void *address =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (address == MAP_FAILED) {
+    error = path + ": " + strerror(errno);
+    return nullptr;
+  }
+
+  return std::shared_ptr<void>(
+      address, [size](void *address) { munmap(address, size); });
+}
+
+template <typename T> bool fits(int64_t number) {
+  return number >= 0 && number <= std::numeric_limits<T>::max();
+}
+
+/// Reads the numbers of a text file in order.
+class TextScanner {
+private:
+  char const *next, *end;
+
+public:
+  TextScanner(char const *begin, char const *end) : next(begin), end(end) {}
+
+  /// Get the next character that is not white space, or 0 at the end.
+  char Peek() {
+    while (next < end && isspace((unsigned char)*next)) {
+      ++next;
+    }
+    return next < end ? *next : 0;
+  }
+
+  void Advance() { ++next; }
+
+  /// Get the number of characters not yet read.
+  size_t GetRemaining() const { return end - next; }
+
+  void SkipLine() {
+    while (next < end && *next++ != '\n') {
+    }
+  }
+
+  /// Read the next integer, skipping the white space and commas before it.
+  /// \return Whether there was an integer in range
+  bool ReadNumber(int64_t &number) {
+
+    while (next < end && (isspace((unsigned char)*next) || *next == ',')) {
+      ++next;
+    }
+
+    bool negative = next < end && *next == '-';
+    next += negative;
+
+    if (next == end || !isdigit((unsigned char)*next)) {
+      return false;
+    }
+
+    uint64_t magnitude = 0;
+
+    for (; next < end && isdigit((unsigned char)*next); ++next) {
+
+      unsigned digit = *next - '0';
+
+      if (magnitude > ((uint64_t)INT64_MAX - digit) / 10) {
+        return false;
+      }
+      magnitude = magnitude * 10 + digit;
+    }
+
+    number = negative ? -(int64_t)magnitude : (int64_t)magnitude;
+    return true;
+  }
+};
+
+template <typename T>
+std::unique_ptr<BasicKnapsackInstance<T>>
+readBinary(std::shared_ptr<void> mapping, size_t size, std::string &error) {
+
+  BinaryHeader header;
+
+  if (size < sizeof(header)) {
+    error = "not a binary instance";
+    return nullptr;
+  }
+
+  memcpy(&header, mapping.get(), sizeof(header));
+
+  if (memcmp(header.magic, binaryMagic, sizeof(binaryMagic)) != 0) {
+    error = "not a binary instance";
+    return nullptr;
+  }
+  if (header.version != binaryVersion) {
+    error = "unknown version, or written in another byte order";
+    return nullptr;
+  }
+  if (header.numberSize != sizeof(T)) {
+    error = "holds " + std::to_string(header.numberSize * 8) +
+            "-bit numbers, not " + std::to_string(sizeof(T) * 8) + "-bit";
+    return nullptr;
+  }
+  if (header.itemCount > INT_MAX || !fits<T>(header.capacity)) {
+    error = "too many items, or the capacity is out of range";
+    return nullptr;
+  }
+
+  uint64_t arraySize = paddedSize(header.itemCount, sizeof(T));
+
+  for (uint64_t offset : {header.weightsOffset, header.valuesOffset}) {
+
+    if (offset % cacheLine != 0 || offset > size || size - offset < arraySize) {
+      error = "truncated, or an array is misplaced";
+      return nullptr;
+    }
+  }
+
+  char *base = static_cast<char *>(mapping.get());
+  T *weights = reinterpret_cast<T *>(base + header.weightsOffset);
+  T *values = reinterpret_cast<T *>(base + header.valuesOffset);
+
+  // Check every item, as the text formats do. The solver reads every page
+  // anyway, so this only faults them in sooner.
+  for (uint64_t i = 0; i < header.itemCount; ++i) {
+
+    if (!fits<T>(values[i]) || !fits<T>(weights[i])) {
+      error = "item " + std::to_string(i + 1) + " is out of range";
+      return nullptr;
+    }
+  }
+
+  return std::unique_ptr<BasicKnapsackInstance<T>>(new BasicKnapsackInstance<T>(
+      header.itemCount, header.capacity, weights, values, std::move(mapping)));
+}
+
+/// Create an instance of `itemCount` items, once the count is known to be
+/// usable.
+/// \param remaining The characters left in the file after the count
+/// \param fieldCount The numbers each item has in the file. Each takes at
+/// least two characters, a digit and a separator, so a count the rest of
+/// the file cannot hold is rejected before anything is allocated for it.
+template <typename T>
+std::unique_ptr<BasicKnapsackInstance<T>>
+makeInstance(int64_t itemCount, int64_t capacity, size_t remaining,
+             int fieldCount, std::string &error) {
+
+  if (itemCount < 0 || itemCount > INT_MAX) {
+    error = "invalid number of items";
+    return nullptr;
+  }
+  if ((uint64_t)itemCount * 2 * fieldCount > remaining + 1) {
+    error = "fewer items than the " + std::to_string(itemCount) + " claimed";
+    return nullptr;
+  }
+  if (!fits<T>(capacity)) {
+    error = "the capacity is out of range";
+    return nullptr;
+  }
+
+  std::unique_ptr<BasicKnapsackInstance<T>> instance(
+      new BasicKnapsackInstance<T>(itemCount));
+  instance->SetCapacity(capacity);
+  return instance;
+}
+
+/// Read every item of an instance. The value and weight of each are found
+/// at `valueField` and `weightField` of its `fieldCount` numbers.
+template <typename T>
+bool readItems(TextScanner &scanner, BasicKnapsackInstance<T> &instance,
+               int fieldCount, int valueField, int weightField,
+               std::string &error) {
+
+  for (int i = 1; i <= instance.GetItemCnt(); ++i) {
+
+    int64_t fields[4];
+
+    for (int f = 0; f < fieldCount; ++f) {
+
+      if (!scanner.ReadNumber(fields[f])) {
+        error = "item " + std::to_string(i) + " is missing or malformed";
+        return false;
+      }
+    }
+
+    int64_t value = fields[valueField], weight = fields[weightField];
+
+    if (!fits<T>(value) || !fits<T>(weight)) {
+      error = "item " + std::to_string(i) + " is out of range";
+      return false;
+    }
+
+    instance.SetItem(i, weight, value);
+  }
+  return true;
+}
+
+template <typename T>
+std::unique_ptr<BasicKnapsackInstance<T>>
+parsePisinger(char const *begin, char const *end, std::string &error) {
+
+  TextScanner scanner(begin, end);
+  int64_t itemCount = -1, capacity = -1;
+
+  // The name, then "key value" lines up to the first item
+  scanner.SkipLine();
+
+  for (char key = scanner.Peek(); !isdigit((unsigned char)key);
+       key = scanner.Peek()) {
+
+    if (key == 0) {
+      error = "no items";
+      return nullptr;
+    }
+
+    scanner.Advance();
+
+    if ((key == 'n' && !scanner.ReadNumber(itemCount)) ||
+        (key == 'c' && !scanner.ReadNumber(capacity))) {
+      error = std::string("malformed '") + key + "' line";
+      return nullptr;
+    }
+
+    scanner.SkipLine();
+  }
+
+  auto instance = makeInstance<T>(itemCount, capacity,
+                                  scanner.GetRemaining(), 4, error);
+
+  // Each item is "<item>,<value>,<weight>,<taken>"
+  if (instance == nullptr || !readItems(scanner, *instance, 4, 1, 2, error)) {
+    return nullptr;
+  }
+  return instance;
+}
+
+template <typename T>
+std::unique_ptr<BasicKnapsackInstance<T>>
+parsePlain(char const *begin, char const *end, std::string &error) {
+
+  TextScanner scanner(begin, end);
+  int64_t itemCount, capacity;
+
+  if (!scanner.ReadNumber(itemCount) || !scanner.ReadNumber(capacity)) {
+    error = "missing the number of items or the capacity";
+    return nullptr;
+  }
+
+  auto instance = makeInstance<T>(itemCount, capacity,
+                                  scanner.GetRemaining(), 2, error);
+
+  // Each item is "<value> <weight>"
+  if (instance == nullptr || !readItems(scanner, *instance, 2, 0, 1, error)) {
+    return nullptr;
+  }
+  return instance;
+}
+
+} // namespace
+
+template <typename T>
+std::unique_ptr<BasicKnapsackInstance<T>>
+KnapsackInstanceFile::Read(std::string const &path) {
+
+  size_t size;
+  auto mapping = mapFile(path, size, error);
+
+  if (mapping == nullptr) {
+    return nullptr;
+  }
+
+  char const *begin = static_cast<char const *>(mapping.get());
+  std::unique_ptr<BasicKnapsackInstance<T>> instance;
+
+  if (size >= sizeof(binaryMagic) &&
+      memcmp(begin, binaryMagic, sizeof(binaryMagic)) == 0) {
+    instance = readBinary<T>(std::move(mapping), size, error);
+  } else {
+    // Pisinger's files start with the instance's name, plain ones with the
+    // number of items.
+    TextScanner scanner(begin, begin + size);
+
+    if (isdigit((unsigned char)scanner.Peek())) {
+      instance = parsePlain<T>(begin, begin + size, error);
+    } else {
+      instance = parsePisinger<T>(begin, begin + size, error);
+    }
+  }
+
+  if (instance == nullptr) {
+    error = path + ": " + error;
+  }
+  return instance;
+}
+
+template <typename T>
+std::unique_ptr<BasicKnapsackInstance<T>>
+KnapsackInstanceFile::ReadBinary(std::string const &path) {
+
+  size_t size;
+  auto mapping = mapFile(path, size, error);
+
+  if (mapping == nullptr) {
+    return nullptr;
+  }
+
+  auto instance = readBinary<T>(std::move(mapping), size, error);
+
+  if (instance == nullptr) {
+    error = path + ": " + error;
+  }
+  return instance;
+}
+
+template <typename T>
+std::unique_ptr<BasicKnapsackInstance<T>>
+KnapsackInstanceFile::ReadPisinger(std::string const &path) {
+
+  size_t size;
+  auto mapping = mapFile(path, size, error);
+
+  if (mapping == nullptr) {
+    return nullptr;
+  }
+
+  char const *begin = static_cast<char const *>(mapping.get());
+  auto instance = parsePisinger<T>(begin, begin + size, error);
+
+  if (instance == nullptr) {
+    error = path + ": " + error;
+  }
+  return instance;
+}
+
+template <typename T>
+std::unique_ptr<BasicKnapsackInstance<T>>
+KnapsackInstanceFile::ReadPlain(std::string const &path) {
+
+  size_t size;
+  auto mapping = mapFile(path, size, error);
+
+  if (mapping == nullptr) {
+    return nullptr;
+  }
+
+  char const *begin = static_cast<char const *>(mapping.get());
+  auto instance = parsePlain<T>(begin, begin + size, error);
+
+  if (instance == nullptr) {
+    error = path + ": " + error;
+  }
+  return instance;
+}
+
+template <typename T>
+bool KnapsackInstanceFile::WriteBinary(BasicKnapsackInstance<T> const &instance,
+                                       std::string const &path) {
+
+  uint64_t itemCount = instance.GetItemCnt();
+  uint64_t arraySize = paddedSize(itemCount, sizeof(T));
+
+  BinaryHeader header = {};
+  memcpy(header.magic, binaryMagic, sizeof(binaryMagic));
+  header.version = binaryVersion;
+  header.numberSize = sizeof(T);
+  header.itemCount = itemCount;
+  header.capacity = instance.GetCapacity();
+  header.weightsOffset = sizeof(header);
+  header.valuesOffset = sizeof(header) + arraySize;
+
+  FILE *file = fopen(path.c_str(), "wb");
+
+  if (file == nullptr) {
+    error = path + ": " + strerror(errno);
+    return false;
+  }
+
+  static char const zeros[cacheLine] = {};
+  size_t padding = arraySize - itemCount * sizeof(T);
+
+  bool written =
+      fwrite(&header, sizeof(header), 1, file) == 1 &&
+      fwrite(instance.GetWeights().data(), sizeof(T), itemCount, file) ==
+          itemCount &&
+      fwrite(zeros, 1, padding, file) == padding &&
+      fwrite(instance.GetValues().data(), sizeof(T), itemCount, file) ==
+          itemCount &&
+      fwrite(zeros, 1, padding, file) == padding;
+
+  if (fclose(file) != 0 || !written) {
+    error = path + ": " + strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+template std::unique_ptr<BasicKnapsackInstance<int16_t>>
+KnapsackInstanceFile::Read(std::string const &);
+template std::unique_ptr<BasicKnapsackInstance<int32_t>>
+KnapsackInstanceFile::Read(std::string const &);
+template std::unique_ptr<BasicKnapsackInstance<int64_t>>
+KnapsackInstanceFile::Read(std::string const &);
+
+template std::unique_ptr<BasicKnapsackInstance<int16_t>>
+KnapsackInstanceFile::ReadBinary(std::string const &);
+template std::unique_ptr<BasicKnapsackInstance<int32_t>>
+KnapsackInstanceFile::ReadBinary(std::string const &);
+template std::unique_ptr<BasicKnapsackInstance<int64_t>>
+KnapsackInstanceFile::ReadBinary(std::string const &);
+
+template std::unique_ptr<BasicKnapsackInstance<int16_t>>
+KnapsackInstanceFile::ReadPisinger(std::string const &);
+template std::unique_ptr<BasicKnapsackInstance<int32_t>>
+KnapsackInstanceFile::ReadPisinger(std::string const &);
+template std::unique_ptr<BasicKnapsackInstance<int64_t>>
+KnapsackInstanceFile::ReadPisinger(std::string const &);
+
+template std::unique_ptr<BasicKnapsackInstance<int16_t>>
+KnapsackInstanceFile::ReadPlain(std::string const &);
+template std::unique_ptr<BasicKnapsackInstance<int32_t>>
+KnapsackInstanceFile::ReadPlain(std::string const &);
+template std::unique_ptr<BasicKnapsackInstance<int64_t>>
+KnapsackInstanceFile::ReadPlain(std::string const &);
+
+template bool
+KnapsackInstanceFile::WriteBinary(BasicKnapsackInstance<int16_t> const &,
+                                  std::string const &);
+template bool
+KnapsackInstanceFile::WriteBinary(BasicKnapsackInstance<int32_t> const &,
+                                  std::string const &);
+template bool
+KnapsackInstanceFile::WriteBinary(BasicKnapsackInstance<int64_t> const &,
+                                  std::string const &);
@@ -0,0 +1,67 @@
+//===-- KnapsackInstanceFile.h - Read and Write Instances -------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackInstanceFile class, which is responsible
+/// for reading 0/1 knapsack problems from files, and for writing them in a
+/// binary format that is read without copying.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKINSTANCEFILE_H
+#define KNAPSACKINSTANCEFILE_H
+
+#include "knapsack.h"
+#include <memory>
+#include <string>
+
+/// Reads and writes 0/1 Knapsack Problems in three formats:
+///
+/// - Binary: a 64-byte header followed by the weights and then the values,
+///   each array 64-byte aligned and padded with zeros to whole cache lines.
+///   The file is mapped into memory and its arrays become the instance's, so
+///   reading costs no more than the page faults of the items touched. Numbers
+///   are in the byte order of the machine that wrote them.
+/// - Pisinger: the output of Pisinger's generators. A name line, then the
+///   lines "n <items>", "c <capacity>", "z <optimum>" and "time <seconds>",
+///   then one line "<item>,<value>,<weight>,<taken>" per item. Only the
+///   first instance of a file is read.
+/// - Plain: "<items> <capacity>", then "<value> <weight>" for every item, as
+///   in OR-Library style instance sets.
+///
+/// Text files are also mapped, and parsed in one pass without allocating.
+class KnapsackInstanceFile {
+private:
+  std::string error;
+
+public:
+  /// Read an instance, telling the format from the start of the file.
+  /// \return The instance, or null if the file cannot be read, in which case
+  /// GetError() says why
+  template <typename T = int32_t>
+  std::unique_ptr<BasicKnapsackInstance<T>> Read(std::string const &path);
+
+  /// Read an instance in the binary format. The width of its numbers must
+  /// be that of T.
+  template <typename T = int32_t>
+  std::unique_ptr<BasicKnapsackInstance<T>> ReadBinary(std::string const &path);
+
+  template <typename T = int32_t>
+  std::unique_ptr<BasicKnapsackInstance<T>>
+  ReadPisinger(std::string const &path);
+
+  template <typename T = int32_t>
+  std::unique_ptr<BasicKnapsackInstance<T>> ReadPlain(std::string const &path);
+
+  /// Write an instance in the binary format.
+  /// \return Whether the file was written. If not, GetError() says why.
+  template <typename T>
+  bool WriteBinary(BasicKnapsackInstance<T> const &instance,
+                   std::string const &path);
+
+  /// Get why the last Read or Write failed.
+  std::string const &GetError() const { return error; }
+};
+
+#endif // KNAPSACKINSTANCEFILE_H
@@ -0,0 +1,395 @@
+//===-- KnapsackParallelBBSolver.cpp - Parallel Branch and Bound ----------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackParallelBBSolver class, which is
+/// responsible for solving 0/1 knapsack problems using Branch and Bound on
+/// several threads at once.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackParallelBBSolver.h"
+#include <algorithm>
+#include <new>
+#include <stdlib.h>
+
+/// Subtrees with fewer undecided items than this are never handed off, since
+/// searching them costs less than moving them to another thread.
+static size_t const minTaskItems = 12;
+
+KnapsackParallelBBSolver::KnapsackParallelBBSolver(
+    UPPER_BOUND const upperBound, unsigned const threadCount)
+    : upperBound(upperBound), threadCount(threadCount > 0 ? threadCount : 1),
+      bestValue(0), pendingTasks(0), idleWorkers(0) {}
+
+KnapsackParallelBBSolver::~KnapsackParallelBBSolver() = default;
+
+void KnapsackParallelBBSolver::WorkersDeleter::operator()(
+    Worker *workers) const {
+
+  for (unsigned t = 0; t < count; ++t) {
+    workers[t].~Worker();
+  }
+  free(workers);
+}
+
+void KnapsackParallelBBSolver::Solve(KnapsackInstance *instance,
+                                     KnapsackSolution *solution) {
+
+  // Choose the search for the bound once, rather than at every node
+  switch (upperBound) {
+  case UB1:
+    solve(instance, solution, UB1Bound());
+    break;
+  case UB2:
+    solve(instance, solution, UB2Bound());
+    break;
+  case UB3:
+    solve(instance, solution, UB3Bound());
+    break;
+  case UB4:
+    solve(instance, solution, UB4Bound());
+    break;
+  case UB5: {
+    UB5Bound bound;
+    bound.depth = enumerationDepth;
+    solve(instance, solution, bound);
+    break;
+  }
+  }
+}
+
+template <typename Bound>
+void KnapsackParallelBBSolver::solve(KnapsackInstance *instance_,
+                                     KnapsackSolution *solution,
+                                     Bound bound) {
+
+  deadline.Start();
+
+  instance = instance_;
+  capacity = instance->GetCapacity();
+
+  int itemCount = instance->GetItemCnt();
+
+  items.clear();
+
+  for (int i = 0; i < itemCount; ++i) {
+    items.emplace_back(Item{i + 1, instance->GetItemWeight(i + 1),
+                            instance->GetItemValue(i + 1)});
+  }
+
+  if (Bound::sortsItems) {
+    std::stable_sort(items.begin(), items.end(),
+                     KnapsackUpperBounds::ByRatio<Item>);
+  }
+
+  bound.Assign(items);
+
+  if (threadPool == nullptr) {
+    threadPool.reset(new ThreadPool(threadCount));
+
+    // sizeof(Worker) is a multiple of 64, so every worker starts a line
+    void *memory;
+    if (posix_memalign(&memory, alignof(Worker),
+                       threadCount * sizeof(Worker)) != 0) {
+      throw std::bad_alloc();
+    }
+    Worker *array = static_cast<Worker *>(memory);
+    for (unsigned t = 0; t < threadCount; ++t) {
+      new (&array[t]) Worker;
+    }
+    workers = std::unique_ptr<Worker[], WorkersDeleter>(
+        array, WorkersDeleter{threadCount});
+  }
+
+  size_t words = (items.size() + 63) / 64;
+
+  stats.Start(items.size());
+
+  for (unsigned t = 0; t < threadCount; ++t) {
+    workers[t].tasks.clear();
+    workers[t].taskCount = 0;
+    workers[t].taken.assign(words, 0);
+    workers[t].nodeCount = 0;
+    workers[t].countdown.Reset(deadline);
+    workers[t].openBound = 0;
+    workers[t].stats.Start(items.size());
+  }
+
+  // Taking nothing is always a valid solution, but a warm start gives every
+  // thread a far better one to prune with from the first node on.
+  int64_t startValue = 0;
+
+  if (warmStarting) {
+    KnapsackSolution warmSolution(instance);
+
+    warmStart.Solve(instance, &warmSolution);
+    solution->Copy(&warmSolution);
+    startValue = warmSolution.GetValue();
+    stats.Improve(startValue);
+  }
+
+  bestValue = startValue;
+  bestTaken.assign(words, 0);
+  bestTakenValue = startValue;
+
+  idleWorkers = 0;
+
+  // The whole tree is the first task
+  pendingTasks = 0;
+  pushTask(workers[0], 0, 0, 0);
+
+  threadPool->Run([this, &bound](unsigned threadNum) {
+    workerLoop(threadNum, bound);
+  });
+
+  // The subtrees left unsearched when time ran out are those of the nodes
+  // every thread stopped at, and the tasks still queued.
+  openBound = 0;
+
+  for (unsigned t = 0; t < threadCount; ++t) {
+
+    openBound = std::max(openBound, workers[t].openBound);
+
+    for (Task const &task : workers[t].tasks) {
+      openBound = std::max<int64_t>(
+          openBound, task.value + bound(task.depth, capacity - task.weight));
+    }
+
+    stats.Merge(workers[t].stats);
+  }
+
+  // Unless no thread beat the starting solution, which is already in place
+  if (bestTakenValue > startValue || !warmStarting) {
+
+    for (int i = 1; i <= itemCount; ++i) {
+      solution->DontTakeItem(i);
+    }
+
+    for (size_t i = 0; i < items.size(); ++i) {
+
+      if (bestTaken[i / 64] >> (i % 64) & 1) {
+        solution->TakeItem(items[i].originalPosition);
+      }
+    }
+  }
+
+  solution->ComputeValue();
+}
+
+KnapsackAnytimeResult
+KnapsackParallelBBSolver::SolveAnytime(KnapsackInstance *instance,
+                                       KnapsackSolution *solution,
+                                       KnapsackBudget const &budget) {
+
+  KnapsackBudget previousBudget = deadline.GetBudget();
+
+  deadline.SetBudget(budget);
+  Solve(instance, solution);
+  deadline.SetBudget(previousBudget);
+
+  return KnapsackAnytimeResult{solution->GetValue(), GetUpperBound(),
+                               deadline.IsExpired(), GetNodeCount(),
+                               deadline.GetSeconds()};
+}
+
+uint64_t KnapsackParallelBBSolver::GetNodeCount() const {
+
+  uint64_t nodeCount = 0;
+
+  for (unsigned t = 0; workers != nullptr && t < threadCount; ++t) {
+    nodeCount += workers[t].nodeCount;
+  }
+  return nodeCount;
+}
+
+template <typename Bound>
+void KnapsackParallelBBSolver::workerLoop(unsigned threadNum,
+                                          Bound const &bound) {
+
+  Worker &worker = workers[threadNum];
+  bool idle = false;
+  Task task;
+
+  while (!deadline.IsExpired()) {
+
+    if (popTask(threadNum, task) || stealTask(threadNum, task)) {
+
+      if (idle) {
+        idleWorkers.fetch_sub(1, std::memory_order_relaxed);
+        idle = false;
+      }
+
+      // Start from the task's path. Bits past its depth are all clear.
+      std::copy(task.taken.begin(), task.taken.end(), worker.taken.begin());
+      std::fill(worker.taken.begin() + task.taken.size(), worker.taken.end(),
+                0);
+
+      search(worker, task.depth, task.weight, task.value, bound);
+
+      pendingTasks.fetch_sub(1, std::memory_order_acq_rel);
+      continue;
+    }
+
+    // No task anywhere. If none is being searched either, the tree is done.
+    if (pendingTasks.load(std::memory_order_acquire) == 0) {
+      break;
+    }
+
+    if (!idle) {
+      idleWorkers.fetch_add(1, std::memory_order_relaxed);
+      idle = true;
+    }
+    std::this_thread::yield();
+  }
+
+  if (idle) {
+    idleWorkers.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+bool KnapsackParallelBBSolver::popTask(unsigned threadNum, Task &task) {
+
+  Worker &worker = workers[threadNum];
+
+  if (worker.taskCount.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+
+  // The owner takes its newest task, which is the deepest one
+  std::lock_guard<std::mutex> lock(worker.mutex);
+
+  if (worker.tasks.empty()) {
+    return false;
+  }
+  task = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  worker.taskCount.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool KnapsackParallelBBSolver::stealTask(unsigned threadNum, Task &task) {
+
+  for (unsigned i = 1; i < threadCount; ++i) {
+
+    Worker &victim = workers[(threadNum + i) % threadCount];
+
+    if (victim.taskCount.load(std::memory_order_relaxed) == 0) {
+      continue;
+    }
+
+    // Thieves take the oldest task, which is the shallowest one
+    std::lock_guard<std::mutex> lock(victim.mutex);
+
+    if (victim.tasks.empty()) {
+      continue;
+    }
+    task = std::move(victim.tasks.front());
+    victim.tasks.pop_front();
+    victim.taskCount.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+void KnapsackParallelBBSolver::pushTask(Worker &worker, size_t depth,
+                                        int32_t weight, int64_t value) {
+
+  Task task{depth, weight, value,
+            std::vector<uint64_t>(worker.taken.begin(),
+                                  worker.taken.begin() + (depth + 63) / 64)};
+
+  pendingTasks.fetch_add(1, std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  worker.tasks.push_back(std::move(task));
+  worker.taskCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename Bound>
+void KnapsackParallelBBSolver::search(Worker &worker, size_t depth,
+                                      int32_t weight, int64_t value,
+                                      Bound const &bound) {
+
+  // If time has run out, leave this node's subtree unsearched
+  if (worker.countdown.Expired()) {
+    worker.openBound = std::max<int64_t>(
+        worker.openBound, value + bound(depth, capacity - weight));
+    return;
+  }
+
+  ++worker.nodeCount;
+
+  worker.stats.Node(depth);
+
+  // Every node is a valid solution: take nothing more.
+  if (value > bestValue.load(std::memory_order_relaxed)) {
+    offerSolution(worker, value);
+  }
+
+  if (depth == items.size()) {
+    worker.stats.Leaf(depth);
+    return;
+  }
+
+  Item const &item = items[depth];
+  uint64_t bit = uint64_t(1) << (depth % 64);
+
+  if ((int64_t)weight + item.weight <= capacity) {
+
+    worker.taken[depth / 64] |= bit;
+
+    search(worker, depth + 1, weight + item.weight, value + item.value,
+           bound);
+
+    worker.taken[depth / 64] &= ~bit;
+  } else {
+    worker.stats.CapacityPrune(depth + 1);
+  }
+
+  // Skip the item only if the items after it could still beat the best
+  // solution found so far
+  auto skipBound = worker.stats.TimeBound(
+      [&] { return bound(depth + 1, capacity - weight); });
+
+  if (value + skipBound <= bestValue.load(std::memory_order_relaxed)) {
+    worker.stats.BoundPrune(depth + 1);
+    return;
+  }
+
+  // Hand the branch off if another thread is waiting for work, and it is big
+  // enough to be worth moving.
+  if (idleWorkers.load(std::memory_order_relaxed) > 0 &&
+      worker.taskCount.load(std::memory_order_relaxed) == 0 &&
+      depth + minTaskItems < items.size()) {
+    pushTask(worker, depth + 1, weight, value);
+    return;
+  }
+
+  search(worker, depth + 1, weight, value, bound);
+}
+
+void KnapsackParallelBBSolver::offerSolution(Worker &worker, int64_t value) {
+
+  int64_t best = bestValue.load(std::memory_order_relaxed);
+
+  while (value > best) {
+
+    if (bestValue.compare_exchange_weak(best, value,
+                                        std::memory_order_relaxed)) {
+
+      // Another thread may have raced past with a better value in between,
+      // so compare again under the lock.
+      worker.stats.Improve(value);
+
+      std::lock_guard<std::mutex> lock(bestMutex);
+
+      if (value > bestTakenValue) {
+        bestTakenValue = value;
+        bestTaken = worker.taken;
+      }
+      return;
+    }
+  }
+}
@@ -0,0 +1,177 @@
+//===-- KnapsackParallelBBSolver.h - Parallel Branch and Bound --*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackParallelBBSolver class, which is
+/// responsible for solving 0/1 knapsack problems using Branch and Bound on
+/// several threads at once.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKPARALLELBBSOLVER_H
+#define KNAPSACKPARALLELBBSOLVER_H
+
+#include "KnapsackDeadline.h"
+#include "KnapsackSearchStats.h"
+#include "KnapsackUpperBounds.h"
+#include "KnapsackWarmStart.h"
+#include "ThreadPool.h"
+#include "knapsack.h"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+/// Provides a solution for a 0/1 Knapsack Problem using depth-first Branch and
+/// Bound on several threads.
+///
+/// Each thread searches its own subtree depth-first. While some thread is
+/// idle, a busy thread hands off the branches it would otherwise search
+/// later, as tasks on its own queue, and idle threads steal the oldest task
+/// of another thread's queue, which is the largest subtree. The best value
+/// found so far is shared through an atomic, so every improvement tightens
+/// pruning on all threads at once.
+class KnapsackParallelBBSolver {
+private:
+  struct Item {
+    /// Specifies the position of this item in the original item list of the
+    /// KnapsackInstance.
+    int originalPosition;
+    int weight;
+    int64_t value;
+  };
+
+  /// A subtree still to be searched: items [0, depth) are decided, and
+  /// `taken` holds one bit per decided item.
+  struct Task {
+    size_t depth;
+    int32_t weight;
+    int64_t value;
+    std::vector<uint64_t> taken;
+  };
+
+  /// The state of one thread, padded so that threads do not share cache
+  /// lines.
+  struct alignas(64) Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    std::atomic<size_t> taskCount{0};
+    /// The decisions on the path to the node being searched
+    std::vector<uint64_t> taken;
+    uint64_t nodeCount = 0;
+    KnapsackDeadline::Countdown countdown;
+    /// The largest bound of a subtree this thread left unsearched
+    int64_t openBound = 0;
+    KnapsackSearchStats stats;
+  };
+
+  /// Destroys and frees the workers, which are allocated on a cache line
+  /// boundary by hand, since C++14's operator new ignores alignas(64)
+  struct WorkersDeleter {
+    unsigned count;
+    void operator()(Worker *workers) const;
+  };
+
+  UPPER_BOUND const upperBound;
+  unsigned const threadCount;
+  std::unique_ptr<ThreadPool> threadPool;
+  std::unique_ptr<Worker[], WorkersDeleter> workers;
+
+  KnapsackInstance *instance = nullptr;
+  KnapsackDeadline deadline;
+  std::vector<Item> items;
+  int32_t capacity = 0;
+
+  KnapsackWarmStart warmStart;
+  bool warmStarting = true;
+
+  /// The statistics of every thread, merged once they are done
+  KnapsackSearchStats stats;
+
+  // Used for upper bound 5
+  unsigned enumerationDepth = 2;
+
+  /// The best value found by any thread. Values are summed in int64_t, since
+  /// the values of items that fit together may add up to more than any one
+  /// of them can hold.
+  std::atomic<int64_t> bestValue;
+  /// The decisions behind the best value, guarded by `bestMutex`
+  std::mutex bestMutex;
+  std::vector<uint64_t> bestTaken;
+  int64_t bestTakenValue = 0;
+  /// The largest bound of a subtree left unsearched when the deadline passed
+  int64_t openBound = 0;
+
+  /// The number of tasks queued or being searched
+  std::atomic<size_t> pendingTasks;
+  std::atomic<unsigned> idleWorkers;
+
+  /// Solve with the bound policy `Bound`, searching with it inlined.
+  template <typename Bound>
+  void solve(KnapsackInstance *instance, KnapsackSolution *solution,
+             Bound bound);
+
+  template <typename Bound>
+  void workerLoop(unsigned threadNum, Bound const &bound);
+  bool popTask(unsigned threadNum, Task &task);
+  bool stealTask(unsigned threadNum, Task &task);
+  void pushTask(Worker &worker, size_t depth, int32_t weight, int64_t value);
+
+  template <typename Bound>
+  void search(Worker &worker, size_t depth, int32_t weight, int64_t value,
+              Bound const &bound);
+
+  /// Record the worker's current path as the best solution, if it is better
+  /// than any other thread's.
+  void offerSolution(Worker &worker, int64_t value);
+
+public:
+  /// \param upperBound The bound used to prune the search
+  /// \param threadCount How many threads search the tree
+  KnapsackParallelBBSolver(UPPER_BOUND const upperBound,
+                           unsigned const threadCount);
+  ~KnapsackParallelBBSolver();
+
+  void Solve(KnapsackInstance *instance, KnapsackSolution *solution);
+
+  /// Solve within a budget, keeping the best solution found when it runs
+  /// out. The budget only applies to this call.
+  /// \return The solution's value, and how far from the optimum it may be
+  KnapsackAnytimeResult SolveAnytime(KnapsackInstance *instance,
+                                     KnapsackSolution *solution,
+                                     KnapsackBudget const &budget);
+
+  /// Set whether to start from a KnapsackWarmStart solution, rather than from
+  /// taking nothing.
+  void SetWarmStart(bool enabled) { warmStarting = enabled; }
+
+  /// Set how many items UB5 decides before bounding with UB3, up to
+  /// KnapsackUpperBounds::maxEnumerationDepth. Only UB5 uses the depth;
+  /// other bounds ignore it.
+  void SetEnumerationDepth(unsigned depth) {
+    enumerationDepth =
+        std::min(depth, KnapsackUpperBounds::maxEnumerationDepth);
+  }
+
+  /// Get the number of search tree nodes the last Solve() explored, over all
+  /// threads.
+  uint64_t GetNodeCount() const;
+
+  /// Get the limits on every Solve(), or cancel a running one from another
+  /// thread.
+  KnapsackDeadline &GetDeadline() { return deadline; }
+
+  /// Get the least upper bound on the optimum the last Solve() proved. This
+  /// is the solution's value, unless the deadline stopped the search.
+  int64_t GetUpperBound() const {
+    return std::max(bestValue.load(), openBound);
+  }
+
+  /// Get what the last Solve() did at each depth of the tree, over all
+  /// threads.
+  KnapsackSearchStats const &GetStats() const { return stats; }
+};
+
+#endif // KNAPSACKPARALLELBBSOLVER_H
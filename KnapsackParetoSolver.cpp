@@ -0,0 +1,181 @@
+//===-- KnapsackParetoSolver.cpp - Solve by Sparse Pareto DP --------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackParetoSolver class, which is responsible for
+/// solving 0/1 knapsack problems using a sparse, Nemhauser-Ullmann style
+/// dynamic program over Pareto-optimal (weight, value) states.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackParetoSolver.h"
+#include <algorithm>
+
+void KnapsackParetoSolver::Solve(KnapsackInstance *instance_,
+                                 KnapsackSolution *solution_) {
+
+  instance = instance_;
+  solution = solution_;
+  capacity = instance->GetCapacity();
+
+  // Items heavier than the knapsack can never be taken, and items without
+  // value are never worth taking, so leave them out.
+  items.clear();
+
+  for (int i = 1; i <= instance->GetItemCnt(); ++i) {
+
+    if (instance->GetItemWeight(i) <= capacity &&
+        instance->GetItemValue(i) > 0) {
+      items.emplace_back(
+          Item{i, instance->GetItemWeight(i), instance->GetItemValue(i)});
+    }
+  }
+
+  // Sort by value / weight, comparing cross products to stay exact.
+  std::stable_sort(items.begin(), items.end(),
+                   [](Item const &a, Item const &b) {
+                     return a.value * b.weight > b.value * a.weight;
+                   });
+
+  prefixWeights.assign(items.size() + 1, 0);
+  prefixValues.assign(items.size() + 1, 0);
+
+  for (size_t i = 0; i < items.size(); ++i) {
+    prefixWeights[i + 1] = prefixWeights[i] + items[i].weight;
+    prefixValues[i + 1] = prefixValues[i] + items[i].value;
+  }
+
+  // The greedy solution gives the first lower bound used for pruning.
+  int64_t greedyWeight = 0;
+  bestValue = 0;
+
+  for (auto const &item : items) {
+    if (greedyWeight + item.weight <= capacity) {
+      greedyWeight += item.weight;
+      bestValue += item.value;
+    }
+  }
+
+  frontier.assign(1, State{0, 0, KnapsackStateHistory::noNode});
+  history.Clear();
+
+  for (size_t i = 0; i < items.size(); ++i) {
+
+    addItem(i);
+
+    if (history.NeedsCompaction()) {
+      history.Compact(frontier);
+    }
+  }
+
+  // Values increase along the frontier, so the last state is the best one.
+  // A state on the optimal path is never pruned, so the frontier is never
+  // empty.
+  history.ForEachItem(frontier.back().node, [this](uint32_t itemNum) {
+    solution->TakeItem(items[itemNum].originalPosition);
+  });
+
+  solution->ComputeValue();
+}
+
+void KnapsackParetoSolver::addItem(size_t itemNum) {
+
+  Item const &item = items[itemNum];
+
+  // The states that can take the item form a prefix of the frontier, since
+  // the frontier is sorted by weight.
+  size_t skipCount = frontier.size();
+  size_t takeCount = 0;
+
+  while (takeCount < skipCount &&
+         frontier[takeCount].weight + item.weight <= capacity) {
+    ++takeCount;
+  }
+
+  nextFrontier.clear();
+
+  size_t skip = 0, take = 0;
+  int64_t lastValue = -1;
+
+  // Merge the states that skip the item with those that take it, by weight.
+  // A state is kept only if it is more valuable than every lighter state.
+  while (skip < skipCount || take < takeCount) {
+
+    State state;
+    bool taken;
+
+    if (take == takeCount) {
+      taken = false;
+    } else if (skip == skipCount) {
+      taken = true;
+    } else {
+      int64_t takeWeight = frontier[take].weight + item.weight;
+      int64_t takeValue = frontier[take].value + item.value;
+
+      taken = takeWeight < frontier[skip].weight ||
+              (takeWeight == frontier[skip].weight &&
+               takeValue > frontier[skip].value);
+    }
+
+    if (taken) {
+      state = frontier[take++];
+      state.weight += item.weight;
+      state.value += item.value;
+    } else {
+      state = frontier[skip++];
+    }
+
+    if (state.value <= lastValue) {
+      continue; // Dominated
+    }
+    lastValue = state.value;
+
+    if (state.value > bestValue) {
+      bestValue = state.value;
+    }
+
+    // If even a fractional filling of the remaining capacity cannot reach
+    // the best value found so far, this state cannot lead to an optimum.
+    int64_t bound = state.value +
+                    fractionalBound(itemNum + 1, capacity - state.weight);
+
+    if (bound < bestValue) {
+      continue;
+    }
+
+    // Only states that survive get a node for the item they took.
+    if (taken) {
+      state.node = history.Add(state.node, itemNum);
+    }
+
+    nextFrontier.push_back(state);
+  }
+
+  frontier.swap(nextFrontier);
+}
+
+int64_t KnapsackParetoSolver::fractionalBound(size_t itemNum,
+                                              int64_t remainingCapacity) const {
+
+  // Find the items that fit entirely: those whose prefix weight stays within
+  // the capacity.
+  int64_t weightLimit = prefixWeights[itemNum] + remainingCapacity;
+
+  size_t fractionalItem =
+      std::upper_bound(prefixWeights.begin() + itemNum, prefixWeights.end(),
+                       weightLimit) -
+      prefixWeights.begin() - 1;
+
+  int64_t bound = prefixValues[fractionalItem] - prefixValues[itemNum];
+
+  if (fractionalItem < items.size()) {
+
+    int64_t fractionalWeight = weightLimit - prefixWeights[fractionalItem];
+
+    bound += fractionalWeight * items[fractionalItem].value /
+             items[fractionalItem].weight;
+  }
+
+  return bound;
+}
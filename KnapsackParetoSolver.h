@@ -0,0 +1,68 @@
+//===-- KnapsackParetoSolver.h - Solve by Sparse Pareto DP ------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackParetoSolver class, which is responsible for
+/// solving 0/1 knapsack problems using a sparse, Nemhauser-Ullmann style
+/// dynamic program over Pareto-optimal (weight, value) states.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKPARETOSOLVER_H
+#define KNAPSACKPARETOSOLVER_H
+
+#include "KnapsackStateHistory.h"
+#include "knapsack.h"
+
+/// Provides a solution for a 0/1 Knapsack Problem by keeping, after each item,
+/// only the states that no other state dominates (lighter and at least as
+/// valuable). Time and memory depend on the number of such states, not on the
+/// capacity, so this works for capacities far too large for a dense table.
+class KnapsackParetoSolver {
+private:
+  struct Item {
+    /// Specifies the position of this item in the original item list of the
+    /// KnapsackInstance.
+    int originalPosition;
+    int64_t weight, value;
+  };
+
+  struct State {
+    int64_t weight, value;
+    /// The node in `history` recording the last item this state took
+    uint32_t node;
+  };
+
+  KnapsackInstance *instance = nullptr;
+  KnapsackSolution *solution = nullptr;
+  int64_t capacity = 0;
+
+  /// The items, sorted by value / weight so that the items still to be
+  /// considered always form a suffix.
+  std::vector<Item> items;
+  /// prefixWeights[i] is the total weight of items [0, i). Likewise values.
+  std::vector<int64_t> prefixWeights, prefixValues;
+
+  std::vector<State> frontier, nextFrontier;
+  KnapsackStateHistory history;
+
+  int64_t bestValue = 0;
+
+  /// Get an upper bound on the value items [itemNum, end) can add within
+  /// `remainingCapacity`, by filling it greedily and taking a fraction of the
+  /// first item that does not fit.
+  int64_t fractionalBound(size_t itemNum, int64_t remainingCapacity) const;
+
+  /// Compute the states after considering item `itemNum`, merging the states
+  /// that skip it with those that take it.
+  void addItem(size_t itemNum);
+
+public:
+  /// Solve a 0/1 Knapsack Problem using a sparse Pareto-frontier DP.
+  /// \param instance The 0/1 Knapsack Problem to be solved
+  /// \param [out] solution The solution to the 0/1 Knapsack Problem
+  void Solve(KnapsackInstance *instance, KnapsackSolution *solution);
+};
+
+#endif // KNAPSACKPARETOSOLVER_H
@@ -0,0 +1,259 @@
+//===-- KnapsackProtocol.cpp - Solver Server Protocol ---------------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackStream class, which reads and writes the
+/// frames KnapsackServer and its clients exchange.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackProtocol.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+/// "KSRQ" and "KSRS", in the byte order of the machine
+uint32_t const requestMagic = 0x5152534b;
+uint32_t const responseMagic = 0x5352534b;
+
+static_assert(sizeof(KnapsackRequestHeader) == 32, "request header padded");
+static_assert(sizeof(KnapsackResponseHeader) == 48, "response header padded");
+
+char const *const solverNames[] = {"core", "dp", "bb"};
+
+} // namespace
+
+KnapsackStream::KnapsackStream(int inFd, int outFd, bool ownsFds)
+    : inFd(inFd), outFd(outFd), ownsFds(ownsFds) {}
+
+KnapsackStream::~KnapsackStream() {
+  if (ownsFds) {
+    close(inFd);
+    if (outFd != inFd && !writingClosed) {
+      close(outFd);
+    }
+  }
+}
+
+bool KnapsackStream::readFully(void *buffer, size_t size) {
+  char *next = (char *)buffer;
+
+  while (size > 0) {
+    ssize_t bytes = read(inFd, next, size);
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes <= 0) {
+      return false;
+    }
+    next += bytes;
+    size -= bytes;
+  }
+  return true;
+}
+
+bool KnapsackStream::writeFully(void const *header, size_t headerSize,
+                                void const *body, size_t bodySize) {
+  iovec parts[2] = {{(void *)header, headerSize}, {(void *)body, bodySize}};
+  iovec *part = parts;
+  int partCount = bodySize > 0 ? 2 : 1;
+
+  std::lock_guard<std::mutex> lock(writeMutex);
+
+  // One call usually writes the whole frame, but a full socket buffer or a
+  // signal may cut it short
+  while (partCount > 0) {
+    ssize_t bytes = writev(outFd, part, partCount);
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes < 0) {
+      return false;
+    }
+    while (partCount > 0 && (size_t)bytes >= part->iov_len) {
+      bytes -= part->iov_len;
+      ++part;
+      --partCount;
+    }
+    if (partCount > 0) {
+      part->iov_base = (char *)part->iov_base + bytes;
+      part->iov_len -= bytes;
+    }
+  }
+  return true;
+}
+
+bool KnapsackStream::ReadRequestHeader(KnapsackRequestHeader &header) {
+  return readFully(&header, sizeof header) && header.magic == requestMagic &&
+         header.itemCount <= maxItems;
+}
+
+bool KnapsackStream::ReadRequestItems(KnapsackRequest &request) {
+  KnapsackRequestHeader const &header = request.header;
+  int n = header.itemCount;
+
+  // A well-formed frame the solvers cannot take gets no instance, and is
+  // answered with RS_INVALID. Its items are still read, to reach the next
+  // frame.
+  bool valid = header.solver <= RQ_BB && header.capacity >= 0 &&
+               header.capacity <= std::numeric_limits<int32_t>::max();
+  int64_t valueSum = 0;
+  int64_t maxValueSum =
+      valid ? requestMaxValueSum((REQUEST_SOLVER)header.solver) : 0;
+
+  request.instance.reset();
+  if (valid) {
+    request.instance.reset(new KnapsackInstance(n));
+    request.instance->SetCapacity((int32_t)header.capacity);
+  }
+
+  // Read the weights and then the values a chunk at a time, straight into
+  // the instance, so that no copy of a large request is kept
+  int32_t chunk[4096];
+  for (int pass = 0; pass < 2; ++pass) {
+    for (int first = 1; first <= n; first += 4096) {
+      int count = std::min(n - first + 1, 4096);
+      if (!readFully(chunk, count * sizeof chunk[0])) {
+        request.instance.reset();
+        return false;
+      }
+      for (int i = 0; valid && i < count; ++i) {
+        KnapsackInstance &instance = *request.instance;
+        valid = chunk[i] >= 0;
+        if (pass == 0) {
+          instance.SetItem(first + i, chunk[i], 0);
+        } else {
+          // Values whose total the solver cannot hold would be answered
+          // with a wrapped value, taken for the optimum
+          valueSum += chunk[i];
+          valid = valid && valueSum <= maxValueSum;
+          instance.SetItem(first + i, instance.GetItemWeight(first + i),
+                           chunk[i]);
+        }
+      }
+    }
+  }
+
+  if (!valid) {
+    request.instance.reset();
+  }
+  return true;
+}
+
+bool KnapsackStream::ReadRequest(KnapsackRequest &request) {
+  request.instance.reset();
+  return ReadRequestHeader(request.header) && ReadRequestItems(request);
+}
+
+bool KnapsackStream::WriteRequest(KnapsackRequestHeader const &header,
+                                  KnapsackInstance const &instance) {
+  KnapsackRequestHeader frame = header;
+  frame.magic = requestMagic;
+  frame.itemCount = instance.GetItemCnt();
+  frame.capacity = instance.GetCapacity();
+
+  auto weights = instance.GetWeights();
+  auto values = instance.GetValues();
+  std::vector<int32_t> body(weights.begin(), weights.end());
+  body.insert(body.end(), values.begin(), values.end());
+
+  return writeFully(&frame, sizeof frame, body.data(),
+                    body.size() * sizeof body[0]);
+}
+
+bool KnapsackStream::ReadResponse(KnapsackResponse &response) {
+  KnapsackResponseHeader &header = response.header;
+
+  if (!readFully(&header, sizeof header) || header.magic != responseMagic ||
+      header.itemCount > maxItems) {
+    return false;
+  }
+  response.takenWords.resize((header.itemCount + 63) / 64);
+  return readFully(response.takenWords.data(),
+                   response.takenWords.size() * sizeof(uint64_t));
+}
+
+bool KnapsackStream::WriteResponse(KnapsackResponseHeader const &header,
+                                   KnapsackSolution const *solution) {
+  KnapsackResponseHeader frame = header;
+  frame.magic = responseMagic;
+  frame.reserved = 0;
+  if (solution == nullptr) {
+    frame.itemCount = 0;
+  }
+
+  std::vector<uint64_t> takenWords((frame.itemCount + 63) / 64);
+  for (uint32_t i = 1; i <= frame.itemCount; ++i) {
+    if (solution->IsTaken(i)) {
+      takenWords[(i - 1) / 64] |= uint64_t(1) << (i - 1) % 64;
+    }
+  }
+
+  return writeFully(&frame, sizeof frame, takenWords.data(),
+                    takenWords.size() * sizeof takenWords[0]);
+}
+
+void KnapsackStream::CloseWriting() {
+  std::lock_guard<std::mutex> lock(writeMutex);
+  if (writingClosed) {
+    return;
+  }
+  if (outFd == inFd) {
+    shutdown(outFd, SHUT_WR);
+  } else {
+    close(outFd);
+  }
+  writingClosed = true;
+}
+
+int connectToServer(std::string const &path, std::string &error) {
+  sockaddr_un address;
+  memset(&address, 0, sizeof address);
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof address.sun_path) {
+    error = path + ": path too long for a socket";
+    return -1;
+  }
+  strcpy(address.sun_path, path.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    error = std::string("socket: ") + strerror(errno);
+    return -1;
+  }
+  if (connect(fd, (sockaddr *)&address, sizeof address) != 0) {
+    error = path + ": " + strerror(errno);
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+char const *requestSolverName(REQUEST_SOLVER solver) {
+  return solverNames[solver];
+}
+
+int64_t requestMaxValueSum(REQUEST_SOLVER solver) {
+  // The DP table's cells hold values in 32 bits; the other solvers sum them
+  // in int64_t, which no request can exceed
+  return solver == RQ_DP ? std::numeric_limits<uint32_t>::max()
+                         : std::numeric_limits<int64_t>::max();
+}
+
+bool findRequestSolver(std::string const &name, REQUEST_SOLVER &solver) {
+  for (int s = RQ_CORE; s <= RQ_BB; ++s) {
+    if (name == solverNames[s]) {
+      solver = (REQUEST_SOLVER)s;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,143 @@
+//===-- KnapsackProtocol.h - Solver Server Protocol -------------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackStream class, which reads and writes the
+/// frames KnapsackServer and its clients exchange, and the frames
+/// themselves.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKPROTOCOL_H
+#define KNAPSACKPROTOCOL_H
+
+#include "knapsack.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Starts every request frame. It is followed by `itemCount` 32-bit weights,
+/// then `itemCount` 32-bit values. Numbers are in the byte order of the
+/// machine, since both ends run on it.
+struct KnapsackRequestHeader {
+  uint32_t magic;
+  /// A REQUEST_SOLVER
+  uint32_t solver;
+  /// Chosen by the client, and sent back with the response
+  uint64_t id;
+  uint32_t itemCount;
+  /// RQ_BB's time budget, or 0 for the solver's default
+  uint32_t budgetMicroseconds;
+  int64_t capacity;
+};
+
+/// Starts every response frame. It is followed by (itemCount + 63) / 64
+/// 64-bit words, in which bit (i-1) % 64 of word (i-1) / 64 is set if item i
+/// is taken.
+struct KnapsackResponseHeader {
+  uint32_t magic;
+  /// A RESPONSE_STATUS
+  uint32_t status;
+  uint64_t id;
+  int64_t value;
+  /// The least upper bound on the optimum the solver proved, which is the
+  /// value unless RQ_BB ran out of time
+  int64_t upperBound;
+  /// The time spent solving, not counting the time queued
+  uint64_t nanoseconds;
+  uint32_t itemCount;
+  uint32_t reserved;
+};
+
+struct KnapsackRequest {
+  KnapsackRequestHeader header;
+  std::unique_ptr<KnapsackInstance> instance;
+};
+
+struct KnapsackResponse {
+  KnapsackResponseHeader header;
+  std::vector<uint64_t> takenWords;
+
+  bool IsTaken(int itemNum) const {
+    return takenWords[(itemNum - 1) / 64] >> (itemNum - 1) % 64 & 1;
+  }
+};
+
+/// Reads and writes frames on a pair of file descriptors, which may be the
+/// same socket or, for a server on stdin and stdout, two pipes.
+///
+/// Any thread may write, and each frame is written whole. Only one thread
+/// may read at a time.
+class KnapsackStream {
+private:
+  int const inFd, outFd;
+  bool const ownsFds;
+  bool writingClosed = false;
+  std::mutex writeMutex;
+
+  bool readFully(void *buffer, size_t size);
+  bool writeFully(void const *header, size_t headerSize, void const *body,
+                  size_t bodySize);
+
+public:
+  /// The most items a request may have. Larger ones are taken as a corrupt
+  /// stream.
+  static uint32_t const maxItems = 1u << 24;
+
+  /// \param ownsFds Whether to close the descriptors with the stream
+  KnapsackStream(int inFd, int outFd, bool ownsFds);
+  ~KnapsackStream();
+
+  KnapsackStream(KnapsackStream const &) = delete;
+  KnapsackStream &operator=(KnapsackStream const &) = delete;
+
+  /// Read the next request.
+  /// \return Whether one was read. False at the end of the stream, and if
+  /// the stream is corrupt.
+  bool ReadRequest(KnapsackRequest &request);
+
+  /// Read the header of the next request, so that the reader can tell how
+  /// large its items are before reading them.
+  /// \return Whether one was read
+  bool ReadRequestHeader(KnapsackRequestHeader &header);
+
+  /// Read the items of the request whose header was just read, into a new
+  /// instance of `request`, which takes about as many bytes as the items
+  /// did on the stream.
+  /// \return Whether they were read
+  bool ReadRequestItems(KnapsackRequest &request);
+
+  bool WriteRequest(KnapsackRequestHeader const &header,
+                    KnapsackInstance const &instance);
+
+  /// Read the next response.
+  /// \return Whether one was read
+  bool ReadResponse(KnapsackResponse &response);
+
+  /// Write a response, with the items of `solution` if it is not null.
+  bool WriteResponse(KnapsackResponseHeader const &header,
+                     KnapsackSolution const *solution);
+
+  /// Stop writing, so that the other end reads the end of the stream once
+  /// it has read every frame written.
+  void CloseWriting();
+};
+
+/// Connect to a server's Unix domain socket.
+/// \return The socket, or -1 with the reason in `error`
+int connectToServer(std::string const &path, std::string &error);
+
+/// Get the name of a solver, such as "core".
+char const *requestSolverName(REQUEST_SOLVER solver);
+
+/// Get the largest total of the values a solver sums without overflowing.
+/// Requests past it are answered with RS_INVALID.
+int64_t requestMaxValueSum(REQUEST_SOLVER solver);
+
+/// Find a solver by its name.
+/// \return Whether there is one
+bool findRequestSolver(std::string const &name, REQUEST_SOLVER &solver);
+
+#endif // KNAPSACKPROTOCOL_H
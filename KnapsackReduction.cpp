@@ -0,0 +1,114 @@
+//===-- KnapsackReduction.cpp - Fix Items Before Solving ------------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackReduction class, which shrinks a 0/1
+/// knapsack problem by fixing the items every optimal solution agrees on.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackReduction.h"
+#include <algorithm>
+
+KnapsackInstance *KnapsackReduction::Reduce(KnapsackInstance *instance_) {
+
+  instance = instance_;
+  int64_t capacity = instance->GetCapacity();
+
+  items.clear();
+  takenItems.clear();
+  freeItems.clear();
+
+  for (int i = 1; i <= instance->GetItemCnt(); ++i) {
+
+    int64_t weight = instance->GetItemWeight(i);
+    int64_t value = instance->GetItemValue(i);
+
+    if (value <= 0 || weight > capacity) {
+      // Never worth taking, or never fits
+      continue;
+    }
+    if (weight == 0) {
+      // Always worth taking
+      takenItems.push_back(i);
+      continue;
+    }
+    items.emplace_back(Item{i, weight, value});
+  }
+
+  // Sort by value / weight, comparing cross products to stay exact.
+  std::stable_sort(items.begin(), items.end(),
+                   [](Item const &a, Item const &b) {
+                     return a.value * b.weight > b.value * a.weight;
+                   });
+
+  bounds.Assign(items);
+
+  // The greedy solution, or the single most valuable item, is the lower
+  // bound every fixed decision must fall short of.
+  int64_t greedyWeight = 0, lowerBound = 0, bestItemValue = 0;
+
+  for (auto const &item : items) {
+
+    if (greedyWeight + item.weight <= capacity) {
+      greedyWeight += item.weight;
+      lowerBound += item.value;
+    }
+    bestItemValue = std::max(bestItemValue, item.value);
+  }
+  lowerBound = std::max(lowerBound, bestItemValue);
+
+  // The tests compare against the lower bound strictly, so every optimal
+  // solution, not just one, agrees with the fixed decisions. The items fixed
+  // taken therefore fit together.
+  int64_t reducedCapacity = capacity;
+
+  for (size_t i = 0; i < items.size(); ++i) {
+
+    Item const &item = items[i];
+
+    if (bounds.DantzigBoundWithout(0, capacity, i) < lowerBound) {
+      takenItems.push_back(item.originalPosition);
+      reducedCapacity -= item.weight;
+      continue;
+    }
+
+    if (item.value + bounds.DantzigBoundWithout(0, capacity - item.weight, i) <
+        lowerBound) {
+      continue; // Left out
+    }
+
+    freeItems.push_back(item.originalPosition);
+  }
+
+  // Keep the free items in their original order
+  std::sort(freeItems.begin(), freeItems.end());
+
+  reduced.reset(new KnapsackInstance(freeItems.size()));
+  reduced->SetCapacity(reducedCapacity);
+
+  for (size_t i = 0; i < freeItems.size(); ++i) {
+    reduced->SetItem(i + 1, instance->GetItemWeight(freeItems[i]),
+                     instance->GetItemValue(freeItems[i]));
+  }
+
+  return reduced.get();
+}
+
+void KnapsackReduction::Expand(KnapsackSolution *reducedSolution,
+                               KnapsackSolution *solution) {
+
+  for (int itemNum : takenItems) {
+    solution->TakeItem(itemNum);
+  }
+
+  for (size_t i = 0; i < freeItems.size(); ++i) {
+
+    if (reducedSolution->IsTaken(i + 1)) {
+      solution->TakeItem(freeItems[i]);
+    }
+  }
+
+  solution->ComputeValue();
+}
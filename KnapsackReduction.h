@@ -0,0 +1,97 @@
+//===-- KnapsackReduction.h - Fix Items Before Solving ----------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackReduction class, which shrinks a 0/1
+/// knapsack problem by fixing the items every optimal solution agrees on, and
+/// the KnapsackReducedSolver class, which runs another solver on the shrunken
+/// problem.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKREDUCTION_H
+#define KNAPSACKREDUCTION_H
+
+#include "KnapsackUpperBounds.h"
+#include "knapsack.h"
+#include <memory>
+#include <utility>
+
+/// Reduces a 0/1 Knapsack Problem in the style of Ingargiola and Korsh.
+///
+/// A greedy solution gives a lower bound on the optimum. An item is fixed
+/// taken if the Dantzig bound without it is below that lower bound, and fixed
+/// left out if the Dantzig bound with it forced in is. Either way, no optimal
+/// solution decides the item otherwise. The remaining items, with the
+/// capacity the fixed items leave, form a smaller problem with the same
+/// optimum.
+class KnapsackReduction {
+private:
+  struct Item {
+    /// Specifies the position of this item in the original item list of the
+    /// KnapsackInstance.
+    int originalPosition;
+    int64_t weight, value;
+  };
+
+  KnapsackInstance *instance = nullptr;
+  std::unique_ptr<KnapsackInstance> reduced;
+
+  /// The items that might be taken, sorted by value / weight
+  std::vector<Item> items;
+  KnapsackUpperBounds bounds;
+
+  /// The original positions of the items fixed taken
+  std::vector<int> takenItems;
+  /// The original position of each item of the reduced problem, by its
+  /// position there less one.
+  std::vector<int> freeItems;
+
+public:
+  /// Reduce a 0/1 Knapsack Problem.
+  /// \param instance The 0/1 Knapsack Problem to be reduced
+  /// \return The reduced problem, which lives until the next call
+  KnapsackInstance *Reduce(KnapsackInstance *instance);
+
+  /// Map a solution of the reduced problem back to the original problem.
+  /// \param reducedSolution A solution to the problem Reduce() returned
+  /// \param [out] solution The matching solution to the original problem
+  void Expand(KnapsackSolution *reducedSolution, KnapsackSolution *solution);
+
+  /// Get the number of items the last Reduce() fixed, taken or not.
+  size_t GetFixedCount() const {
+    return instance->GetItemCnt() - freeItems.size();
+  }
+};
+
+/// Provides a solution for a 0/1 Knapsack Problem by reducing it, solving the
+/// reduced problem with `Solver`, and mapping the solution back.
+template <typename Solver> class KnapsackReducedSolver {
+private:
+  Solver solver;
+  KnapsackReduction reduction;
+
+public:
+  /// \param args The arguments `Solver` is constructed with
+  template <typename... Args>
+  explicit KnapsackReducedSolver(Args &&... args)
+      : solver(std::forward<Args>(args)...) {}
+
+  void Solve(KnapsackInstance *instance, KnapsackSolution *solution) {
+
+    KnapsackInstance *reducedInstance = reduction.Reduce(instance);
+    KnapsackSolution reducedSolution(reducedInstance);
+
+    if (reducedInstance->GetItemCnt() > 0) {
+      solver.Solve(reducedInstance, &reducedSolution);
+    }
+
+    reduction.Expand(&reducedSolution, solution);
+  }
+
+  Solver &GetSolver() { return solver; }
+  KnapsackReduction const &GetReduction() const { return reduction; }
+};
+
+#endif // KNAPSACKREDUCTION_H
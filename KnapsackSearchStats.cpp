@@ -0,0 +1,133 @@
+//===-- KnapsackSearchStats.cpp - Search Tree Statistics ------------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackSearchStats class, which records what the
+/// tree searching solvers do at every depth of the tree, so that bounds and
+/// orderings can be tuned from data.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackSearchStats.h"
+#include <algorithm>
+#include <inttypes.h>
+
+#ifdef KNAPSACK_STATS
+
+void KnapsackSearchStats::Start(size_t maxDepth) {
+
+  depths.assign(maxDepth + 1, DepthCounts());
+  incumbents.clear();
+  boundTime = std::chrono::high_resolution_clock::duration(0);
+  nodeCount = 0;
+  startTime = getTime();
+}
+
+void KnapsackSearchStats::Merge(KnapsackSearchStats const &other) {
+
+  if (depths.size() < other.depths.size()) {
+    depths.resize(other.depths.size());
+  }
+
+  for (size_t d = 0; d < other.depths.size(); ++d) {
+    depths[d].nodes += other.depths[d].nodes;
+    depths[d].leaves += other.depths[d].leaves;
+    depths[d].capacityPrunes += other.depths[d].capacityPrunes;
+    depths[d].boundPrunes += other.depths[d].boundPrunes;
+  }
+
+  // Keep the other search's improvements in time order with ours, counting
+  // their time from our start. Their node counts stay those of the search
+  // that found them.
+  double offset =
+      std::chrono::duration<double>(other.startTime - startTime).count();
+
+  for (Incumbent incumbent : other.incumbents) {
+    incumbent.seconds += offset;
+    incumbents.push_back(incumbent);
+  }
+
+  std::stable_sort(incumbents.begin(), incumbents.end(),
+                   [](Incumbent const &a, Incumbent const &b) {
+                     return a.seconds < b.seconds;
+                   });
+
+  boundTime += other.boundTime;
+  nodeCount += other.nodeCount;
+}
+
+void KnapsackSearchStats::WriteJson(FILE *file, int indent) const {
+
+  int fieldIndent = indent + 2;
+  DepthCounts total;
+  size_t depthCount = 0;
+
+  for (size_t d = 0; d < depths.size(); ++d) {
+
+    DepthCounts const &counts = depths[d];
+
+    total.nodes += counts.nodes;
+    total.leaves += counts.leaves;
+    total.capacityPrunes += counts.capacityPrunes;
+    total.boundPrunes += counts.boundPrunes;
+
+    if (counts.nodes > 0 || counts.leaves > 0 || counts.capacityPrunes > 0 ||
+        counts.boundPrunes > 0) {
+      depthCount = d + 1;
+    }
+  }
+
+  fprintf(file, "{\n");
+  fprintf(file, "%*s\"enabled\": true,\n", fieldIndent, "");
+  fprintf(file, "%*s\"nodes\": %" PRIu64 ",\n", fieldIndent, "",
+          total.nodes);
+  fprintf(file, "%*s\"leaves\": %" PRIu64 ",\n", fieldIndent, "",
+          total.leaves);
+  fprintf(file, "%*s\"capacityPrunes\": %" PRIu64 ",\n", fieldIndent, "",
+          total.capacityPrunes);
+  fprintf(file, "%*s\"boundPrunes\": %" PRIu64 ",\n", fieldIndent, "",
+          total.boundPrunes);
+  fprintf(file, "%*s\"maxDepth\": %zu,\n", fieldIndent, "",
+          depthCount > 0 ? depthCount - 1 : 0);
+  fprintf(file, "%*s\"boundSeconds\": %.9f,\n", fieldIndent, "",
+          GetBoundSeconds());
+
+  fprintf(file, "%*s\"incumbents\": [", fieldIndent, "");
+  for (size_t i = 0; i < incumbents.size(); ++i) {
+    fprintf(file,
+            "%s\n%*s{\"seconds\": %.9f, \"value\": %" PRId64
+            ", \"nodes\": %" PRIu64 "}",
+            i == 0 ? "" : ",", fieldIndent + 2, "", incumbents[i].seconds,
+            incumbents[i].value, incumbents[i].nodes);
+  }
+  fprintf(file, incumbents.empty() ? "],\n" : "\n%*s],\n", fieldIndent, "");
+
+  // One array per count, indexed by depth
+  auto writeDepths = [&](char const *name, uint64_t DepthCounts::*count,
+                         bool last) {
+    fprintf(file, "%*s\"%s\": [", fieldIndent + 2, "", name);
+
+    for (size_t d = 0; d < depthCount; ++d) {
+      fprintf(file, d == 0 ? "%" PRIu64 : ", %" PRIu64, depths[d].*count);
+    }
+    fprintf(file, last ? "]\n" : "],\n");
+  };
+
+  fprintf(file, "%*s\"depths\": {\n", fieldIndent, "");
+  writeDepths("nodes", &DepthCounts::nodes, false);
+  writeDepths("leaves", &DepthCounts::leaves, false);
+  writeDepths("capacityPrunes", &DepthCounts::capacityPrunes, false);
+  writeDepths("boundPrunes", &DepthCounts::boundPrunes, true);
+  fprintf(file, "%*s}\n", fieldIndent, "");
+  fprintf(file, "%*s}", indent, "");
+}
+
+#else
+
+void KnapsackSearchStats::WriteJson(FILE *file, int indent) const {
+  fprintf(file, "{\n%*s\"enabled\": false\n%*s}", indent + 2, "", indent,
+          "");
+}
+
+#endif
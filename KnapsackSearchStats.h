@@ -0,0 +1,110 @@
+//===-- KnapsackSearchStats.h - Search Tree Statistics ----------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackSearchStats class, which records what the
+/// tree searching solvers do at every depth of the tree, so that bounds and
+/// orderings can be tuned from data.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKSEARCHSTATS_H
+#define KNAPSACKSEARCHSTATS_H
+
+#include "Time.h"
+#include <cstdint>
+#include <stdio.h>
+#include <vector>
+
+/// Counts the nodes, leaves and prunes of a search tree by depth, the times
+/// at which the best solution improved, and the time spent evaluating
+/// bounds.
+///
+/// Statistics are only kept when KNAPSACK_STATS is defined, which the CMake
+/// option of the same name does. Otherwise every method but WriteJson() is
+/// empty and inlined away, and the searches cost what they did without it.
+///
+/// A prune is counted at the depth of the node that was cut off, so pruning
+/// the branch that takes item i (1-based) counts at depth i.
+class KnapsackSearchStats {
+public:
+  struct DepthCounts {
+    uint64_t nodes = 0, leaves = 0, capacityPrunes = 0, boundPrunes = 0;
+  };
+
+  struct Incumbent {
+    /// The time since Start(), in seconds
+    double seconds;
+    int64_t value;
+    /// The number of nodes expanded before it was found
+    uint64_t nodes;
+  };
+
+#ifdef KNAPSACK_STATS
+private:
+  std::chrono::high_resolution_clock::time_point startTime;
+  std::vector<DepthCounts> depths;
+  std::vector<Incumbent> incumbents;
+  std::chrono::high_resolution_clock::duration boundTime{0};
+  uint64_t nodeCount = 0;
+
+public:
+  /// Clear the statistics for a search of a tree `maxDepth` items deep.
+  void Start(size_t maxDepth);
+
+  void Node(size_t depth) {
+    ++depths[depth].nodes;
+    ++nodeCount;
+  }
+  void Leaf(size_t depth) { ++depths[depth].leaves; }
+  void CapacityPrune(size_t depth) { ++depths[depth].capacityPrunes; }
+  void BoundPrune(size_t depth) { ++depths[depth].boundPrunes; }
+
+  /// Record that the best solution improved to `value`.
+  void Improve(int64_t value) {
+    incumbents.push_back(
+        Incumbent{timeSince(startTime).count(), value, nodeCount});
+  }
+
+  /// Evaluate a bound, adding the time it takes to the bound time.
+  template <typename F>
+  auto TimeBound(F const &evaluate) -> decltype(evaluate()) {
+    auto start = getTime();
+    auto bound = evaluate();
+    boundTime += getTime() - start;
+    return bound;
+  }
+
+  /// Add the statistics of another search of the same tree, such as that of
+  /// another thread.
+  void Merge(KnapsackSearchStats const &other);
+
+  std::vector<DepthCounts> const &GetDepths() const { return depths; }
+  std::vector<Incumbent> const &GetIncumbents() const { return incumbents; }
+  double GetBoundSeconds() const {
+    return std::chrono::duration<double>(boundTime).count();
+  }
+#else
+public:
+  void Start(size_t) {}
+  void Node(size_t) {}
+  void Leaf(size_t) {}
+  void CapacityPrune(size_t) {}
+  void BoundPrune(size_t) {}
+  void Improve(int64_t) {}
+
+  template <typename F>
+  auto TimeBound(F const &evaluate) -> decltype(evaluate()) {
+    return evaluate();
+  }
+
+  void Merge(KnapsackSearchStats const &) {}
+#endif
+
+  /// Write the statistics as a JSON object, for a line indented by `indent`
+  /// spaces. Without KNAPSACK_STATS the object only says so.
+  void WriteJson(FILE *file, int indent = 0) const;
+};
+
+#endif // KNAPSACKSEARCHSTATS_H
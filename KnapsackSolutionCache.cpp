@@ -0,0 +1,371 @@
+//===-- KnapsackSolutionCache.cpp - Remember Solved Instances -------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackSolutionCache class, which keeps the
+/// solutions of instances already solved, by the hash of their items, in
+/// memory and in a file mapped into memory.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackSolutionCache.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// The start of the file. Offsets are from the end of the header.
+///
+/// The records are in [head, tail), or, once writing has wrapped around to
+/// the start, in [head, wrapAt) and then [0, tail).
+struct KnapsackSolutionCache::DiskHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved0;
+  uint64_t dataSize;
+  uint64_t head, tail;
+  /// The end of the older records once writing has wrapped, or 0
+  uint64_t wrapAt;
+  uint64_t reserved[2];
+};
+
+/// A solution in the file, followed by its taken words
+struct KnapsackSolutionCache::DiskRecord {
+  uint32_t magic;
+  uint32_t itemCount;
+  KnapsackInstanceKey key;
+  int64_t value;
+
+  uint64_t *GetTakenWords() { return (uint64_t *)(this + 1); }
+  uint64_t GetSize() const {
+    return sizeof(DiskRecord) + (itemCount + 63) / 64 * sizeof(uint64_t);
+  }
+};
+
+namespace {
+
+char const diskMagic[8] = {'K', 'N', 'A', 'P', 'S', 'O', 'L', 'N'};
+uint32_t const diskVersion = 3;
+/// "SOLN", starting every record
+uint32_t const recordMagic = 0x4e4c4f53;
+
+uint64_t rotate(uint64_t x, unsigned bits) {
+  return x << bits | x >> (64 - bits);
+}
+
+/// The finalizer of MurmurHash3, which makes every bit of the result depend
+/// on every bit of `x`
+uint64_t mix(uint64_t x) {
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdULL;
+  x ^= x >> 33;
+  x *= 0xc4ceb9fe1a85ec53ULL;
+  x ^= x >> 33;
+  return x;
+}
+
+/// Hash an array eight bytes at a time, into two independent lanes. Only
+/// the `count` numbers are read, so the key does not depend on what follows
+/// them.
+void hashWords(int32_t const *numbers, size_t count, uint64_t &lane0,
+               uint64_t &lane1) {
+
+  char const *bytes = (char const *)numbers;
+  size_t size = count * sizeof(int32_t);
+
+  for (size_t offset = 0; offset < size; offset += sizeof(uint64_t)) {
+    // An odd count ends with half a word, which is filled with zeros
+    uint64_t word = 0;
+    memcpy(&word, bytes + offset, std::min(size - offset, sizeof word));
+
+    lane0 = rotate(lane0 ^ word * 0x87c37b91114253d5ULL, 31) *
+            0x4cf5ad432745937fULL;
+    lane1 = rotate(lane1 ^ word * 0x4cf5ad432745937fULL, 33) *
+            0x87c37b91114253d5ULL;
+  }
+}
+
+} // namespace
+
+KnapsackInstanceKey
+KnapsackSolutionCache::GetKey(KnapsackInstance const &instance) {
+
+  uint64_t lane0 = 0x9e3779b97f4a7c15ULL ^ (uint64_t)instance.GetItemCnt();
+  uint64_t lane1 = 0x6a09e667f3bcc909ULL ^ (uint64_t)instance.GetCapacity();
+
+  hashWords(instance.GetWeights().data(), instance.GetItemCnt(), lane0,
+            lane1);
+  // Keep the weights and the values apart, so that swapping the arrays
+  // changes the key
+  lane0 = rotate(lane0, 17) + 0xbb67ae8584caa73bULL;
+  lane1 = rotate(lane1, 17) + 0x3c6ef372fe94f82bULL;
+  hashWords(instance.GetValues().data(), instance.GetItemCnt(), lane0, lane1);
+
+  lane0 = mix(lane0 + lane1);
+  lane1 = mix(lane1 + lane0);
+  return {{lane0, lane1}};
+}
+
+KnapsackSolutionCache::DiskRecord *
+KnapsackSolutionCache::diskRecord(uint64_t offset) {
+  return (DiskRecord *)(mapping + sizeof(DiskHeader) + offset);
+}
+
+void KnapsackSolutionCache::remember(Entry &&entry) {
+
+  if (entries.size() == memoryEntries) {
+    memoryIndex.erase(entries.back().key);
+    entries.pop_back();
+    ++stats.memoryEvictions;
+  }
+  entries.push_front(std::move(entry));
+  memoryIndex[entries.front().key] = entries.begin();
+}
+
+uint64_t KnapsackSolutionCache::makeDiskRoom(uint64_t size) {
+  DiskHeader &header = diskHeader();
+
+  while (true) {
+    if (header.wrapAt == 0) {
+      if (header.tail + size <= header.dataSize) {
+        return header.tail;
+      }
+      // Wrap around, and overwrite the oldest records from the start
+      header.wrapAt = header.tail;
+      header.tail = 0;
+      continue;
+    }
+
+    if (header.tail + size <= header.head) {
+      return header.tail;
+    }
+
+    DiskRecord *oldest = diskRecord(header.head);
+    auto indexed = diskIndex.find(oldest->key);
+    if (indexed != diskIndex.end() && indexed->second == header.head) {
+      diskIndex.erase(indexed);
+    }
+    ++stats.diskEvictions;
+
+    header.head += oldest->GetSize();
+    if (header.head == header.wrapAt) {
+      // Every record left is in [0, tail)
+      header.head = 0;
+      header.wrapAt = 0;
+    }
+  }
+}
+
+void KnapsackSolutionCache::writeToDisk(Entry const &entry) {
+
+  uint64_t size = sizeof(DiskRecord) + entry.takenWords.size() * 8;
+  if (size > diskHeader().dataSize) {
+    return;
+  }
+
+  uint64_t offset = makeDiskRoom(size);
+  DiskRecord *record = diskRecord(offset);
+  record->magic = recordMagic;
+  record->itemCount = entry.itemCount;
+  record->key = entry.key;
+  record->value = entry.value;
+  memcpy(record->GetTakenWords(), entry.takenWords.data(),
+         entry.takenWords.size() * 8);
+
+  // Only count the record once it is whole
+  diskHeader().tail = offset + size;
+  diskIndex[entry.key] = offset;
+}
+
+bool KnapsackSolutionCache::indexDisk() {
+  DiskHeader &header = diskHeader();
+
+  if (header.head > header.dataSize || header.tail > header.dataSize ||
+      header.wrapAt > header.dataSize ||
+      (header.wrapAt != 0 && header.tail > header.head)) {
+    return false;
+  }
+
+  // Walk [head, wrapAt) if writing has wrapped, then [0, tail)
+  uint64_t offset = header.head;
+  uint64_t end = header.wrapAt != 0 ? header.wrapAt : header.tail;
+
+  while (true) {
+    if (offset == end) {
+      if (end == header.tail) {
+        return true;
+      }
+      offset = 0;
+      end = header.tail;
+      continue;
+    }
+
+    DiskRecord *record = diskRecord(offset);
+    if (end - offset < sizeof(DiskRecord) || record->magic != recordMagic ||
+        end - offset < record->GetSize()) {
+      return false;
+    }
+    diskIndex[record->key] = offset;
+    offset += record->GetSize();
+  }
+}
+
+bool KnapsackSolutionCache::OpenDisk(std::string const &path,
+                                     uint64_t bytes) {
+
+  static_assert(sizeof(DiskHeader) == 64, "the header fills a cache line");
+
+  std::lock_guard<std::mutex> lock(mutex);
+  closeDisk();
+
+  int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+
+  if (fd < 0) {
+    error = path + ": " + strerror(errno);
+    return false;
+  }
+
+  struct stat status;
+
+  if (fstat(fd, &status) != 0) {
+    error = path + ": " + strerror(errno);
+    close(fd);
+    return false;
+  }
+
+  bool created = status.st_size == 0;
+  uint64_t size = status.st_size;
+
+  if (created) {
+    // Round down to whole records' alignment. The file is sparse until
+    // records are written.
+    size = std::max<uint64_t>(bytes, 4096) / 8 * 8;
+    if (ftruncate(fd, size) != 0) {
+      error = path + ": " + strerror(errno);
+      close(fd);
+      return false;
+    }
+  } else if (size < sizeof(DiskHeader)) {
+    error = path + ": not a solution cache";
+    close(fd);
+    return false;
+  }
+
+  void *address =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (address == MAP_FAILED) {
+    error = path + ": " + strerror(errno);
+    return false;
+  }
+  mapping = (char *)address;
+  mappingSize = size;
+
+  DiskHeader &header = diskHeader();
+
+  if (created) {
+    memcpy(header.magic, diskMagic, sizeof(diskMagic));
+    header.version = diskVersion;
+    header.dataSize = size - sizeof(DiskHeader);
+  } else if (memcmp(header.magic, diskMagic, sizeof(diskMagic)) != 0 ||
+             header.version != diskVersion ||
+             header.dataSize != size - sizeof(DiskHeader)) {
+    error = path + ": not a solution cache";
+    closeDisk();
+    return false;
+  }
+
+  if (!indexDisk()) {
+    // A record was cut short, so the records are not to be trusted. Start
+    // again with none.
+    diskIndex.clear();
+    header.head = header.tail = header.wrapAt = 0;
+  }
+  return true;
+}
+
+void KnapsackSolutionCache::closeDisk() {
+  if (mapping != nullptr) {
+    munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+  }
+  diskIndex.clear();
+}
+
+bool KnapsackSolutionCache::Find(KnapsackInstance const &instance,
+                                 KnapsackSolution *solution) {
+
+  KnapsackInstanceKey key = GetKey(instance);
+  std::lock_guard<std::mutex> lock(mutex);
+  Entry const *entry;
+
+  auto remembered = memoryIndex.find(key);
+  auto stored = diskIndex.end();
+
+  if (remembered != memoryIndex.end()) {
+    // Make it the most recently used
+    entries.splice(entries.begin(), entries, remembered->second);
+    entry = &entries.front();
+    ++stats.memoryHits;
+  } else if ((stored = diskIndex.find(key)) != diskIndex.end()) {
+    DiskRecord *record = diskRecord(stored->second);
+    uint64_t *words = record->GetTakenWords();
+    remember({key, record->value, record->itemCount,
+              std::vector<uint64_t>(words,
+                                    words + (record->itemCount + 63) / 64)});
+    entry = &entries.front();
+    ++stats.diskHits;
+  } else {
+    ++stats.misses;
+    return false;
+  }
+
+  for (uint32_t itemNum = 1; itemNum <= entry->itemCount; ++itemNum) {
+    if (entry->takenWords[(itemNum - 1) / 64] >> (itemNum - 1) % 64 & 1) {
+      solution->TakeItem(itemNum);
+    } else {
+      solution->DontTakeItem(itemNum);
+    }
+  }
+  return true;
+}
+
+void KnapsackSolutionCache::Insert(KnapsackInstance const &instance,
+                                   KnapsackSolution const *solution) {
+
+  KnapsackInstanceKey key = GetKey(instance);
+  std::lock_guard<std::mutex> lock(mutex);
+
+  auto remembered = memoryIndex.find(key);
+  if (remembered != memoryIndex.end()) {
+    entries.splice(entries.begin(), entries, remembered->second);
+    return;
+  }
+
+  uint32_t itemCount = instance.GetItemCnt();
+  Entry entry{key, solution->GetValue(), itemCount,
+              std::vector<uint64_t>((itemCount + 63) / 64)};
+  for (uint32_t itemNum = 1; itemNum <= itemCount; ++itemNum) {
+    if (solution->IsTaken(itemNum)) {
+      entry.takenWords[(itemNum - 1) / 64] |= uint64_t(1)
+                                              << (itemNum - 1) % 64;
+    }
+  }
+  ++stats.inserts;
+
+  if (mapping != nullptr && diskIndex.find(key) == diskIndex.end()) {
+    writeToDisk(entry);
+  }
+  remember(std::move(entry));
+}
+
+KnapsackCacheStats KnapsackSolutionCache::GetStats() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
@@ -0,0 +1,178 @@
+//===-- KnapsackSolutionCache.h - Remember Solved Instances -----*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackSolutionCache class, which keeps the
+/// solutions of instances already solved, by the hash of their items, and
+/// the KnapsackCachedSolver class, which looks instances up in a cache before
+/// solving them with another solver.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKSOLUTIONCACHE_H
+#define KNAPSACKSOLUTIONCACHE_H
+
+#include "knapsack.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// A 128-bit hash of an instance's capacity, weights and values. Instances
+/// with the same key are taken to be the same instance.
+struct KnapsackInstanceKey {
+  uint64_t hash[2];
+
+  bool operator==(KnapsackInstanceKey const &other) const {
+    return hash[0] == other.hash[0] && hash[1] == other.hash[1];
+  }
+};
+
+/// The counters of a KnapsackSolutionCache, since it was made.
+struct KnapsackCacheStats {
+  uint64_t memoryHits = 0;
+  /// Lookups missed in memory and found on disk
+  uint64_t diskHits = 0;
+  uint64_t misses = 0;
+  uint64_t inserts = 0;
+  /// Entries dropped from memory to make room, which may still be on disk
+  uint64_t memoryEvictions = 0;
+  /// Entries overwritten on disk to make room
+  uint64_t diskEvictions = 0;
+};
+
+/// Keeps solutions of 0/1 Knapsack Problems, looked up by a hash of the
+/// instance rather than the instance itself, so that hashing the items is
+/// the whole cost of a lookup.
+///
+/// Solutions are kept in memory, where the least recently used are dropped
+/// beyond a number of entries, and, once OpenDisk() is called, in a file
+/// that outlives the process. The file is a ring of records mapped into
+/// memory: new solutions are written after the newest, and when they reach
+/// the end of the file they start again from its beginning, overwriting the
+/// oldest. Its index is rebuilt when the file is opened.
+///
+/// Any solution put in is given back for the same instance, so only exact
+/// solvers' solutions should be put in. All methods may be called from
+/// several threads at once.
+class KnapsackSolutionCache {
+private:
+  struct Entry {
+    KnapsackInstanceKey key;
+    int64_t value;
+    uint32_t itemCount;
+    std::vector<uint64_t> takenWords;
+  };
+
+  struct KeyHash {
+    size_t operator()(KnapsackInstanceKey const &key) const {
+      return key.hash[0];
+    }
+  };
+
+  struct DiskHeader;
+  struct DiskRecord;
+
+  std::mutex mutex;
+  size_t const memoryEntries;
+  /// Entries from the most to the least recently used
+  std::list<Entry> entries;
+  std::unordered_map<KnapsackInstanceKey, std::list<Entry>::iterator, KeyHash>
+      memoryIndex;
+
+  char *mapping = nullptr;
+  size_t mappingSize = 0;
+  /// The offset of every record in the file, from the start of its data
+  std::unordered_map<KnapsackInstanceKey, uint64_t, KeyHash> diskIndex;
+
+  KnapsackCacheStats stats;
+  std::string error;
+
+  DiskHeader &diskHeader() { return *(DiskHeader *)mapping; }
+  DiskRecord *diskRecord(uint64_t offset);
+
+  /// Put an entry in memory as the most recently used.
+  void remember(Entry &&entry);
+
+  /// Make room on disk for a record of `size` bytes, overwriting the oldest
+  /// records if need be.
+  /// \return Where to write the record
+  uint64_t makeDiskRoom(uint64_t size);
+
+  /// Write an entry to disk, if it fits in the file.
+  void writeToDisk(Entry const &entry);
+
+  /// Index the records of a file just mapped.
+  /// \return Whether they are all intact
+  bool indexDisk();
+
+  void closeDisk();
+
+public:
+  /// \param memoryEntries The most solutions to keep in memory
+  explicit KnapsackSolutionCache(size_t memoryEntries = 4096)
+      : memoryEntries(memoryEntries > 0 ? memoryEntries : 1) {}
+  ~KnapsackSolutionCache() { closeDisk(); }
+
+  KnapsackSolutionCache(KnapsackSolutionCache const &) = delete;
+  KnapsackSolutionCache &operator=(KnapsackSolutionCache const &) = delete;
+
+  /// Keep solutions in a file too, and look up the ones already in it. A
+  /// new file is made `bytes` long; an existing one keeps its size.
+  /// \return Whether the file was opened. If not, GetError() says why.
+  bool OpenDisk(std::string const &path, uint64_t bytes);
+
+  /// Hash an instance's capacity, weights and values.
+  static KnapsackInstanceKey GetKey(KnapsackInstance const &instance);
+
+  /// Look up the solution of an instance.
+  /// \param [out] solution The solution, if one was found
+  /// \return Whether one was found
+  bool Find(KnapsackInstance const &instance, KnapsackSolution *solution);
+
+  /// Keep the solution of an instance.
+  void Insert(KnapsackInstance const &instance,
+              KnapsackSolution const *solution);
+
+  KnapsackCacheStats GetStats();
+
+  /// Get why the last OpenDisk() failed.
+  std::string const &GetError() const { return error; }
+};
+
+/// Provides a solution for a 0/1 Knapsack Problem from a cache if it has
+/// been solved before, and otherwise by solving it with `Solver` and adding
+/// the solution to the cache.
+///
+/// Several solvers, such as those of the threads of a pool, may share one
+/// cache.
+template <typename Solver> class KnapsackCachedSolver {
+private:
+  Solver solver;
+  std::shared_ptr<KnapsackSolutionCache> cache;
+
+public:
+  /// \param cache The cache to look in and add to
+  /// \param args The arguments `Solver` is constructed with
+  template <typename... Args>
+  explicit KnapsackCachedSolver(std::shared_ptr<KnapsackSolutionCache> cache,
+                                Args &&... args)
+      : solver(std::forward<Args>(args)...), cache(std::move(cache)) {}
+
+  void Solve(KnapsackInstance *instance, KnapsackSolution *solution) {
+
+    if (!cache->Find(*instance, solution)) {
+      solver.Solve(instance, solution);
+      cache->Insert(*instance, solution);
+    }
+  }
+
+  Solver &GetSolver() { return solver; }
+  KnapsackSolutionCache &GetCache() { return *cache; }
+};
+
+#endif // KNAPSACKSOLUTIONCACHE_H
@@ -0,0 +1,22 @@
+//===-- KnapsackStateHistory.cpp - Item history of DP states --------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackStateHistory class, which records the items
+/// behind each state of the sparse DP solvers so that the chosen state's
+/// items can be recovered without storing an item set per state.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackStateHistory.h"
+
+/// Nodes are compacted once there are this many more of them than were in use
+/// after the previous compaction.
+static size_t const compactionSlack = 1 << 20;
+
+uint32_t const KnapsackStateHistory::noNode;
+
+bool KnapsackStateHistory::NeedsCompaction() const {
+  return nodes.size() > 2 * liveNodes + compactionSlack;
+}
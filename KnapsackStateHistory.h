@@ -0,0 +1,105 @@
+//===-- KnapsackStateHistory.h - Item history of DP states ------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackStateHistory class, which records the items
+/// behind each state of the sparse DP solvers so that the chosen state's
+/// items can be recovered without storing an item set per state.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKSTATEHISTORY_H
+#define KNAPSACKSTATEHISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// A forest of nodes, each recording one item and linking to the node before
+/// it. A state keeps the index of its latest node, and following the parent
+/// links from there lists every item recorded for that state.
+class KnapsackStateHistory {
+private:
+  struct Node {
+    uint32_t parent;
+    uint32_t itemNum;
+  };
+
+  std::vector<Node> nodes;
+  /// The number of nodes still in use after the last compaction.
+  size_t liveNodes = 0;
+
+public:
+  static uint32_t const noNode = UINT32_MAX;
+
+  void Clear() {
+    nodes.clear();
+    liveNodes = 0;
+  }
+
+  /// Record `itemNum` after the node `parent`.
+  /// \returns The new node
+  uint32_t Add(uint32_t parent, uint32_t itemNum) {
+    nodes.push_back(Node{parent, itemNum});
+    return nodes.size() - 1;
+  }
+
+  /// Call `function(itemNum)` for every item recorded up to `node`.
+  template <typename Function>
+  void ForEachItem(uint32_t node, Function const &function) const {
+    for (; node != noNode; node = nodes[node].parent) {
+      function(nodes[node].itemNum);
+    }
+  }
+
+  /// Decide whether enough nodes may have become unreachable for Compact()
+  /// to be worth its cost.
+  bool NeedsCompaction() const;
+
+  /// Drop every node that none of `states` can reach, and renumber the
+  /// `node` member of each state to match.
+  template <typename States> void Compact(States &states);
+};
+
+template <typename States> void KnapsackStateHistory::Compact(States &states) {
+
+  std::vector<uint32_t> newIndex(nodes.size(), noNode);
+  std::vector<Node> compacted;
+  std::vector<uint32_t> path;
+
+  compacted.reserve(2 * liveNodes + states.size());
+
+  for (auto &state : states) {
+
+    // Collect the nodes on this state's chain that are not yet copied...
+    path.clear();
+
+    for (uint32_t node = state.node;
+         node != noNode && newIndex[node] == noNode;
+         node = nodes[node].parent) {
+      path.push_back(node);
+    }
+
+    // ...and copy them parents first, so every parent has its new index.
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+
+      Node node = nodes[*it];
+
+      if (node.parent != noNode) {
+        node.parent = newIndex[node.parent];
+      }
+      newIndex[*it] = compacted.size();
+      compacted.push_back(node);
+    }
+
+    if (state.node != noNode) {
+      state.node = newIndex[state.node];
+    }
+  }
+
+  nodes.swap(compacted);
+  liveNodes = nodes.size();
+}
+
+#endif // KNAPSACKSTATEHISTORY_H
@@ -0,0 +1,162 @@
+//===-- KnapsackUpperBounds.cpp - Bounds on Sorted Items ------------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackUpperBounds class, which computes upper
+/// bounds on the value a suffix of items sorted by value / weight can add to
+/// a knapsack.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackUpperBounds.h"
+#include <algorithm>
+
+unsigned const KnapsackUpperBounds::maxEnumerationDepth;
+
+int64_t KnapsackUpperBounds::DantzigBound(size_t itemNum,
+                                          int64_t capacity) const {
+  size_t breakItem;
+  return fractionalBound(itemNum, capacity, nullptr, 0, breakItem);
+}
+
+int64_t KnapsackUpperBounds::DantzigBoundWithout(size_t itemNum,
+                                                 int64_t capacity,
+                                                 size_t excludedItem) const {
+  size_t breakItem;
+  return fractionalBound(itemNum, capacity, &excludedItem, 1, breakItem);
+}
+
+int64_t KnapsackUpperBounds::MartelloTothBound(size_t itemNum,
+                                               int64_t capacity) const {
+
+  size_t breakItem;
+  int64_t dantzig = fractionalBound(itemNum, capacity, nullptr, 0, breakItem);
+
+  if (breakItem == weights.size()) {
+    return dantzig; // Every item fits
+  }
+
+  // The items before the break item fit entirely, leaving `residual`
+  int64_t fitValue = prefixValues[breakItem] - prefixValues[itemNum];
+  int64_t residual =
+      capacity - (prefixWeights[breakItem] - prefixWeights[itemNum]);
+
+  // Leave the break item out
+  int64_t bound = fitValue;
+  size_t next = breakItem + 1;
+
+  if (next < weights.size() && weights[next] > 0) {
+    bound += residual * values[next] / weights[next];
+  }
+
+  // Take the break item, freeing the weight it needs from the items before it
+  if (breakItem > itemNum) {
+
+    size_t previous = breakItem - 1;
+
+    if (weights[previous] == 0) {
+      // Freeing weight costs nothing we can bound, so fall back to UB3
+      return dantzig;
+    }
+
+    int64_t excess = weights[breakItem] - residual;
+    int64_t lost =
+        (excess * values[previous] + weights[previous] - 1) / weights[previous];
+
+    bound = std::max(bound, fitValue + values[breakItem] - lost);
+  }
+
+  return std::min(bound, dantzig);
+}
+
+int64_t KnapsackUpperBounds::EnumerativeBound(size_t itemNum,
+                                              int64_t capacity,
+                                              unsigned depth) const {
+
+  size_t excluded[maxEnumerationDepth];
+
+  return enumerativeBound(itemNum, capacity,
+                          std::min(depth, maxEnumerationDepth), excluded, 0);
+}
+
+int64_t KnapsackUpperBounds::fractionalBound(size_t itemNum, int64_t capacity,
+                                             size_t const *excluded,
+                                             size_t excludedCount,
+                                             size_t &breakItem) const {
+
+  int64_t bound = 0;
+  size_t begin = itemNum;
+
+  // Fill the knapsack one run of items between excluded items at a time
+  for (size_t e = 0;; ++e) {
+
+    size_t end = e < excludedCount ? excluded[e] : weights.size();
+    int64_t runWeight = prefixWeights[end] - prefixWeights[begin];
+
+    if (runWeight > capacity) {
+
+      // Find the items that fit entirely: those whose prefix weight stays
+      // within the capacity.
+      int64_t weightLimit = prefixWeights[begin] + capacity;
+
+      breakItem = std::upper_bound(prefixWeights.begin() + begin,
+                                   prefixWeights.begin() + end + 1,
+                                   weightLimit) -
+                  prefixWeights.begin() - 1;
+
+      int64_t fractionalWeight = weightLimit - prefixWeights[breakItem];
+
+      return bound + prefixValues[breakItem] - prefixValues[begin] +
+             fractionalWeight * values[breakItem] / weights[breakItem];
+    }
+
+    capacity -= runWeight;
+    bound += prefixValues[end] - prefixValues[begin];
+
+    if (e == excludedCount) {
+      breakItem = weights.size();
+      return bound;
+    }
+    begin = end + 1;
+  }
+}
+
+int64_t KnapsackUpperBounds::enumerativeBound(size_t itemNum,
+                                              int64_t capacity, unsigned depth,
+                                              size_t *excluded,
+                                              size_t excludedCount) const {
+
+  size_t breakItem;
+  int64_t bound =
+      fractionalBound(itemNum, capacity, excluded, excludedCount, breakItem);
+
+  if (depth == 0 || breakItem == weights.size()) {
+    return bound;
+  }
+
+  // Decide the break item, keeping the excluded items sorted
+  size_t position = excludedCount;
+
+  for (; position > 0 && excluded[position - 1] > breakItem; --position) {
+    excluded[position] = excluded[position - 1];
+  }
+  excluded[position] = breakItem;
+
+  int64_t best = enumerativeBound(itemNum, capacity, depth - 1, excluded,
+                                  excludedCount + 1);
+
+  if (weights[breakItem] <= capacity) {
+    best = std::max(best, values[breakItem] +
+                              enumerativeBound(itemNum,
+                                               capacity - weights[breakItem],
+                                               depth - 1, excluded,
+                                               excludedCount + 1));
+  }
+
+  for (size_t i = position; i < excludedCount; ++i) {
+    excluded[i] = excluded[i + 1];
+  }
+
+  return std::min(best, bound);
+}
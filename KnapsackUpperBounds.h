@@ -0,0 +1,217 @@
+//===-- KnapsackUpperBounds.h - Bounds on Sorted Items ----------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackUpperBounds class, which computes upper
+/// bounds on the value a suffix of items sorted by value / weight can add to
+/// a knapsack, and the bound policies the branch-and-bound searches are
+/// templates over.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKUPPERBOUNDS_H
+#define KNAPSACKUPPERBOUNDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Computes the bounds that rely on items being sorted by value / weight
+/// (UB3, UB4 and UB5), over the items [itemNum, end) and a given capacity.
+///
+/// Prefix sums of the weights and values let the break item of the
+/// fractional knapsack be found by binary search, so each bound costs
+/// O(log n), or O(2^depth * depth * log n) for the enumerative bound. The
+/// bounds only read the prefix sums, so several threads may share one
+/// object.
+class KnapsackUpperBounds {
+private:
+  std::vector<int64_t> weights, values;
+  /// prefixWeights[i] and prefixValues[i] are the total weight and value of
+  /// items [0, i).
+  std::vector<int64_t> prefixWeights, prefixValues;
+
+  /// Solve the fractional knapsack over items [itemNum, end) except the
+  /// sorted `excluded` items.
+  /// \param [out] breakItem The item only a fraction of which fits, or the
+  /// item count if every item fits
+  int64_t fractionalBound(size_t itemNum, int64_t capacity,
+                          size_t const *excluded, size_t excludedCount,
+                          size_t &breakItem) const;
+
+  int64_t enumerativeBound(size_t itemNum, int64_t capacity, unsigned depth,
+                           size_t *excluded, size_t excludedCount) const;
+
+public:
+  /// Order items by value / weight, most valuable first, as Assign() expects.
+  /// Weightless items come first. Cross products keep the order exact.
+  template <typename Item> static bool ByRatio(Item const &a, Item const &b) {
+
+    if ((a.weight == 0) != (b.weight == 0)) {
+      return a.weight == 0;
+    }
+    return (int64_t)a.value * b.weight > (int64_t)b.value * a.weight;
+  }
+
+  /// The deepest enumeration EnumerativeBound() performs
+  static unsigned const maxEnumerationDepth = 8;
+
+  /// Take the items to bound. They must be sorted by value / weight, most
+  /// valuable first, and have `weight` and `value` members.
+  template <typename Items> void Assign(Items const &items) {
+
+    weights.clear();
+    values.clear();
+
+    for (auto const &item : items) {
+      weights.push_back(item.weight);
+      values.push_back(item.value);
+    }
+
+    prefixWeights.assign(weights.size() + 1, 0);
+    prefixValues.assign(values.size() + 1, 0);
+
+    for (size_t i = 0; i < weights.size(); ++i) {
+      prefixWeights[i + 1] = prefixWeights[i] + weights[i];
+      prefixValues[i + 1] = prefixValues[i] + values[i];
+    }
+  }
+
+  /// Get the Dantzig bound (UB3): the value of the fractional knapsack.
+  int64_t DantzigBound(size_t itemNum, int64_t capacity) const;
+
+  /// Get the Dantzig bound over the items except `excludedItem`, which must
+  /// not come before `itemNum`.
+  int64_t DantzigBoundWithout(size_t itemNum, int64_t capacity,
+                              size_t excludedItem) const;
+
+  /// Get the Martello-Toth bound U2 (UB4). Either the break item is left
+  /// out, and the rest of the capacity is filled at the value / weight of the
+  /// item after it, or it is taken, and the weight it needs is freed at the
+  /// value / weight of the item before it.
+  int64_t MartelloTothBound(size_t itemNum, int64_t capacity) const;
+
+  /// Get the enumerative bound (UB5): the larger Dantzig bound of taking or
+  /// leaving out the break item, deciding the break item of each branch the
+  /// same way until `depth` items are decided.
+  int64_t EnumerativeBound(size_t itemNum, int64_t capacity,
+                           unsigned depth) const;
+};
+
+//===-- Bound Policies ----------------------------------------------------===//
+//
+// Each policy bounds the value items [itemNum, end) can add within a
+// remaining capacity, holding only the state its bound needs. Searches are
+// templates over a policy, so that the bound is inlined into them.
+//
+//===----------------------------------------------------------------------===//
+
+/// UB1: the total value of the items, whether they fit or not
+class UB1Bound {
+  /// suffixValues[i] is the total value of items [i, end).
+  std::vector<int64_t> suffixValues;
+
+public:
+  static bool const sortsItems = false;
+
+  template <typename Items> void Assign(Items const &items) {
+
+    suffixValues.assign(items.size() + 1, 0);
+
+    for (size_t i = items.size(); i > 0; --i) {
+      suffixValues[i - 1] = suffixValues[i] + items[i - 1].value;
+    }
+  }
+
+  int64_t operator()(size_t itemNum, int64_t) const {
+    return suffixValues[itemNum];
+  }
+};
+
+/// UB2: the total value of the items that fit on their own
+class UB2Bound {
+  std::vector<int64_t> weights, values;
+
+public:
+  static bool const sortsItems = false;
+
+  template <typename Items> void Assign(Items const &items) {
+
+    weights.clear();
+    values.clear();
+
+    for (auto const &item : items) {
+      weights.push_back(item.weight);
+      values.push_back(item.value);
+    }
+  }
+
+  int64_t operator()(size_t itemNum, int64_t remainingCapacity) const {
+
+    int64_t sum = 0;
+
+    for (size_t i = itemNum; i < weights.size(); ++i) {
+
+      // An item that exactly fills the knapsack fits too. Leaving it out
+      // made the bound less than the optimum, and pruned optimal branches.
+      if (weights[i] <= remainingCapacity) {
+        sum += values[i];
+      }
+    }
+    return sum;
+  }
+};
+
+/// UB3: the Dantzig bound
+class UB3Bound {
+  KnapsackUpperBounds bounds;
+
+public:
+  static bool const sortsItems = true;
+
+  template <typename Items> void Assign(Items const &items) {
+    bounds.Assign(items);
+  }
+
+  int64_t operator()(size_t itemNum, int64_t remainingCapacity) const {
+    return bounds.DantzigBound(itemNum, remainingCapacity);
+  }
+};
+
+/// UB4: the Martello-Toth bound U2
+class UB4Bound {
+  KnapsackUpperBounds bounds;
+
+public:
+  static bool const sortsItems = true;
+
+  template <typename Items> void Assign(Items const &items) {
+    bounds.Assign(items);
+  }
+
+  int64_t operator()(size_t itemNum, int64_t remainingCapacity) const {
+    return bounds.MartelloTothBound(itemNum, remainingCapacity);
+  }
+};
+
+/// UB5: the enumerative bound
+class UB5Bound {
+  KnapsackUpperBounds bounds;
+
+public:
+  static bool const sortsItems = true;
+
+  /// How many items are decided before bounding with UB3
+  unsigned depth = 2;
+
+  template <typename Items> void Assign(Items const &items) {
+    bounds.Assign(items);
+  }
+
+  int64_t operator()(size_t itemNum, int64_t remainingCapacity) const {
+    return bounds.EnumerativeBound(itemNum, remainingCapacity, depth);
+  }
+};
+
+#endif // KNAPSACKUPPERBOUNDS_H
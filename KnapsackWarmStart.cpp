@@ -0,0 +1,264 @@
+//===-- KnapsackWarmStart.cpp - Heuristic Starting Solution ---------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackWarmStart class, which is responsible for
+/// quickly finding a good, though not necessarily optimal, solution to a 0/1
+/// knapsack problem, for exact solvers to start from.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackWarmStart.h"
+#include <algorithm>
+
+size_t const KnapsackWarmStart::swapWindow;
+size_t const KnapsackWarmStart::maxSwaps;
+
+void KnapsackWarmStart::Solve(KnapsackInstance *instance,
+                              KnapsackSolution *solution) {
+
+  capacity = instance->GetCapacity();
+
+  items.clear();
+
+  for (int i = 1; i <= instance->GetItemCnt(); ++i) {
+
+    int64_t weight = instance->GetItemWeight(i);
+    int64_t value = instance->GetItemValue(i);
+
+    if (value <= 0 || weight > capacity) {
+      // Never worth taking, or never fits
+      continue;
+    }
+    if (weight == 0) {
+      // Always worth taking
+      solution->TakeItem(i);
+      continue;
+    }
+    items.emplace_back(Item{i, weight, value});
+  }
+
+  // Sort by value / weight, comparing cross products to stay exact.
+  std::stable_sort(items.begin(), items.end(),
+                   [](Item const &a, Item const &b) {
+                     return a.value * b.weight > b.value * a.weight;
+                   });
+
+  taken.assign(items.size(), false);
+  takenWeight = takenValue = 0;
+  fill();
+
+  // The greedy solution can be arbitrarily bad when one valuable item does
+  // not fit alongside the others, so also try starting from that item.
+  size_t bestItem = 0;
+
+  for (size_t i = 1; i < items.size(); ++i) {
+    if (items[i].value > items[bestItem].value) {
+      bestItem = i;
+    }
+  }
+
+  if (!items.empty() && !taken[bestItem]) {
+
+    std::vector<bool> greedyTaken = taken;
+    int64_t greedyWeight = takenWeight, greedyValue = takenValue;
+
+    taken.assign(items.size(), false);
+    takenWeight = takenValue = 0;
+    take(bestItem);
+    fill();
+
+    if (takenValue <= greedyValue) {
+      taken.swap(greedyTaken);
+      takenWeight = greedyWeight;
+      takenValue = greedyValue;
+    }
+  }
+
+  for (size_t swaps = 0; swaps < maxSwaps && (swapOne() || swapTwo());
+       ++swaps) {
+    fill();
+  }
+
+  for (size_t i = 0; i < items.size(); ++i) {
+
+    if (taken[i]) {
+      solution->TakeItem(items[i].originalPosition);
+    }
+  }
+
+  solution->ComputeValue();
+}
+
+void KnapsackWarmStart::take(size_t itemNum) {
+  taken[itemNum] = true;
+  takenWeight += items[itemNum].weight;
+  takenValue += items[itemNum].value;
+}
+
+void KnapsackWarmStart::dontTake(size_t itemNum) {
+  taken[itemNum] = false;
+  takenWeight -= items[itemNum].weight;
+  takenValue -= items[itemNum].value;
+}
+
+void KnapsackWarmStart::fill() {
+
+  for (size_t i = 0; i < items.size(); ++i) {
+
+    if (!taken[i] && takenWeight + items[i].weight <= capacity) {
+      take(i);
+    }
+  }
+}
+
+bool KnapsackWarmStart::swapOne() {
+
+  // Sort the items left out by weight, and find the most valuable of each
+  // prefix, so that the best item fitting any weight is a binary search away.
+  std::vector<size_t> left;
+
+  for (size_t i = 0; i < items.size(); ++i) {
+    if (!taken[i]) {
+      left.push_back(i);
+    }
+  }
+
+  std::sort(left.begin(), left.end(), [this](size_t a, size_t b) {
+    return items[a].weight < items[b].weight;
+  });
+
+  std::vector<size_t> mostValuable(left.size());
+
+  for (size_t k = 0; k < left.size(); ++k) {
+
+    mostValuable[k] = left[k];
+
+    if (k > 0 && items[mostValuable[k - 1]].value > items[left[k]].value) {
+      mostValuable[k] = mostValuable[k - 1];
+    }
+  }
+
+  int64_t bestGain = 0;
+  size_t bestOut = 0, bestIn = 0;
+
+  for (size_t i = 0; i < items.size(); ++i) {
+
+    if (!taken[i]) {
+      continue;
+    }
+
+    int64_t weightLimit = capacity - takenWeight + items[i].weight;
+
+    size_t fitCount =
+        std::upper_bound(left.begin(), left.end(), weightLimit,
+                         [this](int64_t limit, size_t itemNum) {
+                           return limit < items[itemNum].weight;
+                         }) -
+        left.begin();
+
+    if (fitCount == 0) {
+      continue;
+    }
+
+    size_t in = mostValuable[fitCount - 1];
+    int64_t gain = items[in].value - items[i].value;
+
+    if (gain > bestGain) {
+      bestGain = gain;
+      bestOut = i;
+      bestIn = in;
+    }
+  }
+
+  if (bestGain == 0) {
+    return false;
+  }
+
+  dontTake(bestOut);
+  take(bestIn);
+  return true;
+}
+
+bool KnapsackWarmStart::swapTwo() {
+
+  // The least valuable taken items and the most valuable ones left out, by
+  // value / weight
+  std::vector<size_t> outs, ins;
+
+  for (size_t i = items.size(); i-- > 0 && outs.size() < swapWindow;) {
+    if (taken[i]) {
+      outs.push_back(i);
+    }
+  }
+
+  for (size_t i = 0; i < items.size() && ins.size() < swapWindow; ++i) {
+    if (!taken[i]) {
+      ins.push_back(i);
+    }
+  }
+
+  // Every set of up to two items, as pairs of indices where `noItem` stands
+  // for no item
+  static size_t const noItem = SIZE_MAX;
+
+  auto forEachSet = [](std::vector<size_t> const &candidates,
+                       size_t minimumSize, auto &&fn) {
+    if (minimumSize == 0) {
+      fn(noItem, noItem);
+    }
+    for (size_t a = 0; a < candidates.size(); ++a) {
+      fn(candidates[a], noItem);
+
+      for (size_t b = a + 1; b < candidates.size(); ++b) {
+        fn(candidates[a], candidates[b]);
+      }
+    }
+  };
+
+  auto weightOf = [this](size_t a, size_t b) {
+    return (a == noItem ? 0 : items[a].weight) +
+           (b == noItem ? 0 : items[b].weight);
+  };
+  auto valueOf = [this](size_t a, size_t b) {
+    return (a == noItem ? 0 : items[a].value) +
+           (b == noItem ? 0 : items[b].value);
+  };
+
+  int64_t bestGain = 0;
+  size_t bestOut[2], bestIn[2];
+
+  forEachSet(outs, 0, [&](size_t outA, size_t outB) {
+    int64_t freeWeight = capacity - takenWeight + weightOf(outA, outB);
+    int64_t lostValue = valueOf(outA, outB);
+
+    forEachSet(ins, 1, [&](size_t inA, size_t inB) {
+      int64_t gain = valueOf(inA, inB) - lostValue;
+
+      if (gain > bestGain && weightOf(inA, inB) <= freeWeight) {
+        bestGain = gain;
+        bestOut[0] = outA;
+        bestOut[1] = outB;
+        bestIn[0] = inA;
+        bestIn[1] = inB;
+      }
+    });
+  });
+
+  if (bestGain == 0) {
+    return false;
+  }
+
+  for (size_t itemNum : bestOut) {
+    if (itemNum != noItem) {
+      dontTake(itemNum);
+    }
+  }
+  for (size_t itemNum : bestIn) {
+    if (itemNum != noItem) {
+      take(itemNum);
+    }
+  }
+  return true;
+}
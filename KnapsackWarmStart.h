@@ -0,0 +1,68 @@
+//===-- KnapsackWarmStart.h - Heuristic Starting Solution -------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackWarmStart class, which is responsible for
+/// quickly finding a good, though not necessarily optimal, solution to a 0/1
+/// knapsack problem, for exact solvers to start from.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACKWARMSTART_H
+#define KNAPSACKWARMSTART_H
+
+#include "knapsack.h"
+
+/// Provides a heuristic solution for a 0/1 Knapsack Problem.
+///
+/// The solution starts as the better of the greedy solution, which takes
+/// every item that fits in order of value / weight, and the most valuable
+/// single item filled up greedily. A local search then exchanges items while
+/// that improves the value: one taken item for one left out, and, near the
+/// break item, up to two taken items for up to two left out. After each
+/// exchange, any item that fits is taken.
+class KnapsackWarmStart {
+private:
+  struct Item {
+    /// Specifies the position of this item in the original item list of the
+    /// KnapsackInstance.
+    int originalPosition;
+    int64_t weight, value;
+  };
+
+  /// The most items on each side of the break item that two-item exchanges
+  /// consider.
+  static size_t const swapWindow = 16;
+  /// The most exchanges the local search makes
+  static size_t const maxSwaps = 64;
+
+  int64_t capacity = 0;
+  /// The items that might be taken, sorted by value / weight
+  std::vector<Item> items;
+  std::vector<bool> taken;
+  int64_t takenWeight = 0, takenValue = 0;
+
+  void take(size_t itemNum);
+  void dontTake(size_t itemNum);
+
+  /// Take every item that fits, in order of value / weight.
+  void fill();
+
+  /// Make the best exchange of one taken item for one left out.
+  /// \return Whether an exchange improved the value
+  bool swapOne();
+
+  /// Make the best exchange of up to two taken items for up to two left out,
+  /// among the items nearest the break item.
+  /// \return Whether an exchange improved the value
+  bool swapTwo();
+
+public:
+  /// Find a good solution to a 0/1 Knapsack Problem.
+  /// \param instance The 0/1 Knapsack Problem to be solved
+  /// \param [out] solution The solution found
+  void Solve(KnapsackInstance *instance, KnapsackSolution *solution);
+};
+
+#endif // KNAPSACKWARMSTART_H
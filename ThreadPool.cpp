@@ -0,0 +1,107 @@
+//===-- ThreadPool.cpp - Persistent fork-join worker pool -----------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the ThreadPool class, a fixed set of worker threads that
+/// is created once and then used for many short parallel steps, such as one
+/// DP row per step.
+//===----------------------------------------------------------------------===//
+
+#include "ThreadPool.h"
+
+/// How many times a thread yields while waiting before it goes to sleep.
+/// Tasks such as DP rows are short, so most waits end while still spinning.
+static unsigned const spinCount = 256;
+
+ThreadPool::ThreadPool(unsigned threadCount) : generation(0), pending(0) {
+
+  for (unsigned i = 1; i < threadCount; ++i) {
+    workers.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+    generation.fetch_add(1, std::memory_order_release);
+  }
+  taskReady.notify_all();
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::Run(std::function<void(unsigned)> const &task_) {
+
+  if (workers.empty()) {
+    task_(0);
+    return;
+  }
+
+  task = &task_;
+  pending.store(workers.size(), std::memory_order_relaxed);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    generation.fetch_add(1, std::memory_order_release);
+  }
+  taskReady.notify_all();
+
+  task_(0);
+
+  // Wait for the workers, spinning briefly before going to sleep
+  for (unsigned spin = 0; spin < spinCount; ++spin) {
+    if (pending.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+    std::this_thread::yield();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  taskDone.wait(lock, [this] {
+    return pending.load(std::memory_order_acquire) == 0;
+  });
+}
+
+void ThreadPool::workerLoop(unsigned threadNum) {
+
+  uint64_t seenGeneration = 0;
+
+  while (true) {
+
+    // Wait for the next task, spinning briefly before going to sleep
+    bool ready = false;
+
+    for (unsigned spin = 0; spin < spinCount && !ready; ++spin) {
+      ready = generation.load(std::memory_order_acquire) != seenGeneration;
+      if (!ready) {
+        std::this_thread::yield();
+      }
+    }
+
+    if (!ready) {
+      std::unique_lock<std::mutex> lock(mutex);
+      taskReady.wait(lock, [this, seenGeneration] {
+        return generation.load(std::memory_order_acquire) != seenGeneration;
+      });
+    }
+
+    seenGeneration = generation.load(std::memory_order_acquire);
+
+    // `stopping` is set before the generation is released, so it can be
+    // read without the lock here
+    if (stopping) {
+      return;
+    }
+
+    (*task)(threadNum);
+
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      std::lock_guard<std::mutex> lock(mutex);
+      taskDone.notify_one();
+    }
+  }
+}
@@ -0,0 +1,60 @@
+//===-- ThreadPool.h - Persistent fork-join worker pool ---------*- C++ -*-===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the ThreadPool class, a fixed set of worker threads that
+/// is created once and then used for many short parallel steps, such as one
+/// DP row per step.
+//===----------------------------------------------------------------------===//
+
+#ifndef KNAPSACK_THREADPOOL_H
+#define KNAPSACK_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// A fixed set of threads that run a task together and wait for each other
+/// to finish it. The calling thread takes part in every task as thread 0, so
+/// a pool of n threads only starts n-1 workers.
+class ThreadPool {
+private:
+  std::vector<std::thread> workers;
+  std::function<void(unsigned)> const *task = nullptr;
+
+  std::mutex mutex;
+  std::condition_variable taskReady;
+  std::condition_variable taskDone;
+
+  // Incremented for every task. Workers run the task whenever it changes.
+  std::atomic<uint64_t> generation;
+  // The number of workers that have not yet finished the current task.
+  std::atomic<unsigned> pending;
+  bool stopping = false;
+
+  void workerLoop(unsigned threadNum);
+
+public:
+  /// \param threadCount The number of threads to run each task on, counting
+  /// the calling thread
+  explicit ThreadPool(unsigned threadCount);
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const &) = delete;
+  ThreadPool &operator=(ThreadPool const &) = delete;
+
+  /// Get the number of threads each task runs on, counting the caller.
+  unsigned GetThreadCount() const { return workers.size() + 1; }
+
+  /// Run `task(threadNum)` once on every thread of the pool, and return once
+  /// they have all finished. The caller runs it with threadNum 0.
+  void Run(std::function<void(unsigned)> const &task);
+};
+
+#endif // KNAPSACK_THREADPOOL_H
@@ -0,0 +1,698 @@
+//===-- benchmark.cpp - 0/1 Knapsack Problem solver benchmarks ------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackBenchmark program, which times solvers on
+/// generated instances and writes the results as text, JSON or CSV.
+///
+/// By default it sweeps solvers x instance classes x sizes, running each
+/// solver a few times untimed and then timing repeated trials, and reports
+/// the minimum, median and 95th percentile. With --largest it instead finds
+/// the largest number of items each solver solves within a time limit, as in
+/// the bottom section of benchmarks.txt, which is reproduced by
+///
+///   KnapsackBenchmark --largest 10 --classes strongly-correlated --range 100
+///
+/// With --batch it solves many instances of each size at once on a pool of
+/// threads, as a server would, and reports the throughput.
+///
+/// Every solution is checked against the core solver's. The branch-and-bound
+/// and backtracking solvers give up after 10 seconds with the best solution
+/// found so far, which may still be optimal.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackBatchSolver.h"
+#include "KnapsackBBSolver.h"
+#include "KnapsackBTSolver.h"
+#include "KnapsackCoreSolver.h"
+#include "KnapsackDPSolver.h"
+#include "KnapsackGenerator.h"
+#include "KnapsackParallelBBSolver.h"
+#include "KnapsackParetoSolver.h"
+#include "KnapsackReduction.h"
+#include "KnapsackSolutionCache.h"
+#include "knapsack.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <functional>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+typedef std::function<void(KnapsackInstance *, KnapsackSolution *)>
+    SolveFunction;
+
+/// Wrap a new `Solver` constructed from `args`.
+template <typename Solver, typename... Args>
+static SolveFunction makeSolve(Args... args) {
+  auto solver = std::make_shared<Solver>(args...);
+  return [solver](KnapsackInstance *instance, KnapsackSolution *solution) {
+    solver->Solve(instance, solution);
+  };
+}
+
+/// Every solver the benchmark knows, by the name the Knapsack driver prints
+static std::vector<std::pair<std::string, std::function<SolveFunction()>>> const
+    solvers = {
+        {"DP", [] { return makeSolve<KnapsackDPSolver>(DP_FULL_TABLE); }},
+        {"DP-LM", [] { return makeSolve<KnapsackDPSolver>(DP_LINEAR_MEMORY); }},
+        {"DP-BP", [] { return makeSolve<KnapsackDPSolver>(DP_BIT_PACKED); }},
+        {"DP-MT",
+         [] {
+           return makeSolve<KnapsackDPSolver>(
+               DP_BIT_PACKED, std::thread::hardware_concurrency());
+         }},
+        {"DP-V", [] { return makeSolve<KnapsackDPSolver>(DP_BY_VALUE); }},
+        {"DP-AUTO", [] { return makeSolve<KnapsackDPSolver>(DP_AUTO); }},
+        {"Pareto", [] { return makeSolve<KnapsackParetoSolver>(); }},
+        {"Core", [] { return makeSolve<KnapsackCoreSolver>(); }},
+        {"DP-RED",
+         [] {
+           return makeSolve<KnapsackReducedSolver<KnapsackDPSolver>>(DP_AUTO);
+         }},
+        {"Core-CACHE",
+         [] {
+           return makeSolve<KnapsackCachedSolver<KnapsackCoreSolver>>(
+               std::make_shared<KnapsackSolutionCache>());
+         }},
+        {"BB-RED",
+         [] {
+           return makeSolve<KnapsackReducedSolver<KnapsackBBSolver>>(UB3);
+         }},
+        {"BF", [] { return makeSolve<KnapsackBFSolver>(); }},
+        {"BT", [] { return makeSolve<KnapsackBTSolver>(); }},
+        {"BB-UB1", [] { return makeSolve<KnapsackBBSolver>(UB1); }},
+        {"BB-UB2", [] { return makeSolve<KnapsackBBSolver>(UB2); }},
+        {"BB-UB3", [] { return makeSolve<KnapsackBBSolver>(UB3); }},
+        {"BB-UB4", [] { return makeSolve<KnapsackBBSolver>(UB4); }},
+        {"BB-UB5", [] { return makeSolve<KnapsackBBSolver>(UB5); }},
+        {"BB-BF",
+         [] { return makeSolve<KnapsackBBSolver>(UB3, BB_BEST_FIRST); }},
+        {"BB-HY", [] { return makeSolve<KnapsackBBSolver>(UB3, BB_HYBRID); }},
+        {"BB-MT",
+         [] {
+           return makeSolve<KnapsackParallelBBSolver>(
+               UB3, std::thread::hardware_concurrency());
+         }},
+};
+
+struct Options {
+  std::vector<std::string> solvers;
+  std::vector<INSTANCE_CLASS> classes = {
+      IC_UNCORRELATED, IC_WEAKLY_CORRELATED, IC_STRONGLY_CORRELATED};
+  std::vector<int> sizes = {100, 1000};
+  int64_t range = 1000;
+  double capacityFraction = 0.5;
+  uint64_t seed = 1;
+  unsigned warmups = 1;
+  unsigned trials = 5;
+  /// The time limit in seconds for --largest, or 0 to sweep
+  double largest = 0;
+  /// The number of instances to solve at once, or 0 to time one at a time
+  unsigned batch = 0;
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  int maxSize = 1 << 20;
+  /// The most memory the benchmark may allocate, in MiB, or 0 for no limit
+  uint64_t memoryLimit = 0;
+  std::string format = "text";
+  std::string output;
+};
+
+/// One row of results. For --largest, `size` is the largest number of items
+/// solved, and the times are those of solving it.
+struct Result {
+  std::string solver;
+  INSTANCE_CLASS instanceClass;
+  int size;
+  int64_t capacity;
+  unsigned trials;
+  int64_t minNs, medianNs, p95Ns;
+  int64_t value, expectedValue;
+  /// Whether some run ran out of memory
+  bool outOfMemory;
+  double instancesPerSecond;
+};
+
+static void usage(char const *program) {
+  printf("Usage: %s [options]\n"
+         "  --solvers A,B,...   solvers to run (default: DP-AUTO,Pareto,"
+         "Core,DP-RED,\n"
+         "                      or DP,BF,BT,BB-UB1,BB-UB2,BB-UB3 with "
+         "--largest)\n"
+         "  --classes A,B,...   instance classes (default: uncorrelated,"
+         "weakly-correlated,\n"
+         "                      strongly-correlated)\n"
+         "  --sizes N,M,...     numbers of items (default: 100,1000)\n"
+         "  --range R           largest weight drawn (default: 1000)\n"
+         "  --fraction F        capacity, as a fraction of the total weight "
+         "(default: 0.5)\n"
+         "  --seed S            generator seed (default: 1)\n"
+         "  --warmups W         untimed runs before the trials (default: 1)\n"
+         "  --trials T          timed runs (default: 5)\n"
+         "  --largest SECONDS   find the largest size solved within SECONDS\n"
+         "  --max-size N        largest size --largest tries (default: "
+         "1048576)\n"
+         "  --batch N           solve N instances of each size at once, with "
+         "consecutive\n"
+         "                      seeds, timing each one; --trials is ignored\n"
+         "  --threads T         instances solved at once with --batch "
+         "(default: cores)\n"
+         "  --memory-limit MIB  most memory to allocate, so that solvers "
+         "needing more\n"
+         "                      fail rather than the system killing the "
+         "benchmark\n"
+         "                      (default: no limit)\n"
+         "  --format F          text, json or csv (default: text)\n"
+         "  --output PATH       write the results to PATH instead of stdout\n"
+         "Solvers:",
+         program);
+  for (auto const &solver : solvers) {
+    printf(" %s", solver.first.c_str());
+  }
+  printf("\nClasses:");
+  for (int c = IC_UNCORRELATED; c <= IC_PROFIT_CEILING; ++c) {
+    printf(" %s", instanceClassName((INSTANCE_CLASS)c));
+  }
+  printf("\n");
+}
+
+static std::vector<std::string> split(char const *list) {
+  std::vector<std::string> items;
+  std::string item;
+
+  for (char const *c = list;; ++c) {
+    if (*c == ',' || *c == '\0') {
+      if (!item.empty()) {
+        items.push_back(item);
+      }
+      item.clear();
+      if (*c == '\0') {
+        return items;
+      }
+    } else {
+      item += *c;
+    }
+  }
+}
+
+static bool findSolver(std::string const &name, SolveFunction &solve) {
+  for (auto const &solver : solvers) {
+    if (solver.first == name) {
+      solve = solver.second();
+      return true;
+    }
+  }
+  return false;
+}
+
+static Options parseOptions(int argc, char *argv[]) {
+  Options options;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string option = argv[i];
+
+    if (option == "--help" || option == "-h") {
+      usage(argv[0]);
+      exit(0);
+    }
+    if (i + 1 == argc) {
+      printf("Missing the value of %s\n", option.c_str());
+      exit(1);
+    }
+    char const *value = argv[++i];
+
+    if (option == "--solvers") {
+      options.solvers = split(value);
+    } else if (option == "--classes") {
+      options.classes.clear();
+      for (auto const &name : split(value)) {
+        int c = IC_UNCORRELATED;
+        while (c <= IC_PROFIT_CEILING &&
+               name != instanceClassName((INSTANCE_CLASS)c)) {
+          ++c;
+        }
+        if (c > IC_PROFIT_CEILING) {
+          printf("Unknown instance class %s\n", name.c_str());
+          exit(1);
+        }
+        options.classes.push_back((INSTANCE_CLASS)c);
+      }
+    } else if (option == "--sizes") {
+      options.sizes.clear();
+      for (auto const &size : split(value)) {
+        options.sizes.push_back(atoi(size.c_str()));
+      }
+    } else if (option == "--range") {
+      options.range = atoll(value);
+    } else if (option == "--fraction") {
+      options.capacityFraction = atof(value);
+    } else if (option == "--seed") {
+      options.seed = strtoull(value, NULL, 10);
+    } else if (option == "--warmups") {
+      options.warmups = atoi(value);
+    } else if (option == "--trials") {
+      options.trials = std::max(1, atoi(value));
+    } else if (option == "--largest") {
+      options.largest = atof(value);
+    } else if (option == "--batch") {
+      options.batch = atoi(value);
+    } else if (option == "--threads") {
+      options.threads = std::max(1, atoi(value));
+    } else if (option == "--max-size") {
+      options.maxSize = atoi(value);
+    } else if (option == "--memory-limit") {
+      options.memoryLimit = strtoull(value, NULL, 10);
+    } else if (option == "--format") {
+      options.format = value;
+    } else if (option == "--output") {
+      options.output = value;
+    } else {
+      printf("Unknown option %s\n", option.c_str());
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+
+  if (options.solvers.empty()) {
+    if (options.largest > 0) {
+      options.solvers = {"DP", "BF", "BT", "BB-UB1", "BB-UB2", "BB-UB3"};
+    } else {
+      options.solvers = {"DP-AUTO", "Pareto", "Core", "DP-RED"};
+    }
+  }
+
+  SolveFunction solve;
+  for (auto const &name : options.solvers) {
+    if (!findSolver(name, solve)) {
+      printf("Unknown solver %s\n", name.c_str());
+      exit(1);
+    }
+  }
+  if (options.format != "text" && options.format != "json" &&
+      options.format != "csv") {
+    printf("Unknown format %s\n", options.format.c_str());
+    exit(1);
+  }
+  return options;
+}
+
+/// Solve an instance once.
+/// \param [out] value The value of the solution found
+/// \param [out] outOfMemory Whether the solver ran out of memory
+/// \return The time taken in nanoseconds
+static int64_t timeSolve(SolveFunction const &solve, KnapsackInstance *instance,
+                         int64_t &value, bool &outOfMemory) {
+
+  KnapsackSolution solution(instance);
+
+  auto start = std::chrono::steady_clock::now();
+  try {
+    solve(instance, &solution);
+  } catch (std::bad_alloc const &) {
+    outOfMemory = true;
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  value = solution.GetValue();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+      .count();
+}
+
+static std::unique_ptr<KnapsackInstance>
+generate(Options const &options, INSTANCE_CLASS instanceClass, int size,
+         uint64_t seedOffset = 0) {
+
+  std::unique_ptr<KnapsackInstance> instance(new KnapsackInstance(size));
+  KnapsackGenerator generator(instanceClass);
+
+  generator.SetSeed(options.seed + seedOffset);
+  generator.SetRange(options.range);
+  generator.SetCapacityFraction(options.capacityFraction);
+  generator.Generate(instance.get());
+  return instance;
+}
+
+/// The optimal value of an instance by the core solver, or INVALID_VALUE if
+/// it runs out of memory
+static int64_t solveExactly(KnapsackInstance *instance) {
+  KnapsackCoreSolver solver;
+  KnapsackSolution solution(instance);
+
+  try {
+    solver.Solve(instance, &solution);
+  } catch (std::bad_alloc const &) {
+    return INVALID_VALUE;
+  }
+  return solution.GetValue();
+}
+
+/// Whether a result has the optimal value, or could not be checked
+static bool isCorrect(Result const &result) {
+  return result.expectedValue == INVALID_VALUE ||
+         result.value == result.expectedValue;
+}
+
+/// Run warm-ups, then timed trials, of one solver on one instance.
+static Result measure(std::string const &solver,
+                      INSTANCE_CLASS instanceClass, KnapsackInstance *instance,
+                      int64_t expectedValue, unsigned warmups,
+                      unsigned trials) {
+
+  Result result{};
+  result.solver = solver;
+  result.instanceClass = instanceClass;
+  result.size = instance->GetItemCnt();
+  result.capacity = instance->GetCapacity();
+  result.trials = trials;
+  result.expectedValue = expectedValue;
+  SolveFunction solve;
+  findSolver(solver, solve);
+
+  std::vector<int64_t> times;
+
+  for (unsigned i = 0; i < warmups + trials && !result.outOfMemory; ++i) {
+
+    int64_t value;
+    int64_t time = timeSolve(solve, instance, value, result.outOfMemory);
+
+    if (i >= warmups) {
+      times.push_back(time);
+    }
+    // Keep the worst value, so that any wrong answer shows
+    result.value = i == 0 ? value : std::min(result.value, value);
+  }
+
+  if (!times.empty()) {
+    std::sort(times.begin(), times.end());
+    result.trials = times.size();
+    result.minNs = times.front();
+    result.medianNs = times[(times.size() - 1) / 2];
+    result.p95Ns = times[(times.size() * 95 + 99) / 100 - 1];
+    result.instancesPerSecond = 1e9 / std::max<int64_t>(result.medianNs, 1);
+  }
+  return result;
+}
+
+/// A solver chosen by name, so that KnapsackBatchSolver can make one for
+/// every thread
+class NamedSolver {
+private:
+  SolveFunction solve;
+
+public:
+  bool outOfMemory = false;
+
+  explicit NamedSolver(std::string const &name) { findSolver(name, solve); }
+
+  void Solve(KnapsackInstance *instance, KnapsackSolution *solution) {
+    try {
+      solve(instance, solution);
+    } catch (std::bad_alloc const &) {
+      outOfMemory = true;
+    }
+  }
+};
+
+/// Solve a batch of instances of one class and size at once, after solving
+/// it untimed `options.warmups` times.
+static Result measureBatch(Options const &options, std::string const &solver,
+                           INSTANCE_CLASS instanceClass, int size) {
+
+  std::vector<std::unique_ptr<KnapsackInstance>> ownedInstances;
+  std::vector<std::unique_ptr<KnapsackSolution>> ownedSolutions;
+  std::vector<KnapsackInstance *> instances;
+  std::vector<KnapsackSolution *> solutions;
+  std::vector<int64_t> expectedValues;
+
+  for (unsigned i = 0; i < options.batch; ++i) {
+    ownedInstances.push_back(generate(options, instanceClass, size, i));
+    instances.push_back(ownedInstances.back().get());
+    ownedSolutions.emplace_back(new KnapsackSolution(instances.back()));
+    solutions.push_back(ownedSolutions.back().get());
+    expectedValues.push_back(solveExactly(instances.back()));
+  }
+
+  KnapsackBatchSolver<NamedSolver> batchSolver(options.threads, solver);
+
+  for (unsigned i = 0; i < options.warmups; ++i) {
+    batchSolver.Solve(instances, solutions);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  batchSolver.Solve(instances, solutions);
+  auto end = std::chrono::steady_clock::now();
+
+  Result result{};
+  result.solver = solver;
+  result.instanceClass = instanceClass;
+  result.size = size;
+  result.capacity = instances[0]->GetCapacity();
+  result.trials = options.batch;
+  result.value = solutions[0]->GetValue();
+  result.expectedValue = expectedValues[0];
+
+  for (unsigned t = 0; t < batchSolver.GetThreadCount(); ++t) {
+    result.outOfMemory |= batchSolver.GetSolver(t).outOfMemory;
+  }
+
+  // Report the first wrong value, if there is one
+  for (unsigned i = 0; i < options.batch; ++i) {
+    result.value = solutions[i]->GetValue();
+    result.expectedValue = expectedValues[i];
+    if (!isCorrect(result)) {
+      break;
+    }
+  }
+
+  std::vector<int64_t> times;
+  for (double seconds : batchSolver.GetSeconds()) {
+    times.push_back(seconds * 1e9);
+  }
+  std::sort(times.begin(), times.end());
+  result.minNs = times.front();
+  result.medianNs = times[(times.size() - 1) / 2];
+  result.p95Ns = times[(times.size() * 95 + 99) / 100 - 1];
+  result.instancesPerSecond =
+      options.batch / std::chrono::duration<double>(end - start).count();
+  return result;
+}
+
+static std::vector<Result> sweep(Options const &options) {
+  std::vector<Result> results;
+
+  for (INSTANCE_CLASS instanceClass : options.classes) {
+    for (int size : options.sizes) {
+
+      auto instance = generate(options, instanceClass, size);
+      int64_t expectedValue = solveExactly(instance.get());
+
+      for (auto const &solver : options.solvers) {
+        if (options.batch > 0) {
+          results.push_back(
+              measureBatch(options, solver, instanceClass, size));
+        } else {
+          results.push_back(measure(solver, instanceClass, instance.get(),
+                                    expectedValue, options.warmups,
+                                    options.trials));
+        }
+        fprintf(stderr, "%s %s n=%d done\n", solver.c_str(),
+                instanceClassName(instanceClass), size);
+      }
+    }
+  }
+  return results;
+}
+
+/// Find the largest size a solver solves correctly within the time limit,
+/// doubling the size until it fails and then bisecting.
+static Result findLargest(Options const &options, std::string const &solver,
+                          INSTANCE_CLASS instanceClass) {
+
+  int64_t limitNs = options.largest * 1e9;
+  Result best{};
+  best.solver = solver;
+  best.instanceClass = instanceClass;
+
+  auto solves = [&](int size) {
+    auto instance = generate(options, instanceClass, size);
+    Result result = measure(solver, instanceClass, instance.get(),
+                            solveExactly(instance.get()), 0, 1);
+
+    bool solved =
+        !result.outOfMemory && result.medianNs <= limitNs && isCorrect(result);
+    if (solved) {
+      best = result;
+    }
+    fprintf(stderr, "%s %s n=%d: %s\n", solver.c_str(),
+            instanceClassName(instanceClass), size,
+            solved ? "solved" : "not solved");
+    return solved;
+  };
+
+  int low = 0, high = 0;
+
+  for (int size = 8; size <= options.maxSize; size *= 2) {
+    if (!solves(size)) {
+      high = size;
+      break;
+    }
+    low = size;
+  }
+
+  // Stop once the size is known to within 1%
+  while (high > 0 && high - low > std::max(1, low / 100)) {
+    int middle = low + (high - low) / 2;
+
+    if (solves(middle)) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  return best;
+}
+
+static void write(FILE *file, Options const &options,
+                  std::vector<Result> const &results) {
+
+  if (options.format == "json") {
+    fprintf(file,
+            "{\n  \"mode\": \"%s\",\n  \"range\": %lld,\n  \"fraction\": "
+            "%g,\n  \"seed\": %llu,\n  \"warmups\": %u,\n  \"threads\": "
+            "%u,\n  \"results\": [",
+            options.largest > 0 ? "largest"
+                                : options.batch > 0 ? "batch" : "sweep",
+            (long long)options.range, options.capacityFraction,
+            (unsigned long long)options.seed, options.warmups,
+            options.batch > 0 ? options.threads : 1);
+
+    for (size_t i = 0; i < results.size(); ++i) {
+      Result const &r = results[i];
+      fprintf(file,
+              "%s\n    {\"solver\": \"%s\", \"class\": \"%s\", \"n\": %d, "
+              "\"capacity\": %lld, \"trials\": %u, \"min_ns\": %lld, "
+              "\"median_ns\": %lld, \"p95_ns\": %lld, \"value\": %lld, "
+              "\"expected_value\": %lld, \"correct\": %s, "
+              "\"out_of_memory\": %s, \"instances_per_second\": %.3f}",
+              i == 0 ? "" : ",", r.solver.c_str(),
+              instanceClassName(r.instanceClass), r.size,
+              (long long)r.capacity, r.trials, (long long)r.minNs,
+              (long long)r.medianNs, (long long)r.p95Ns, (long long)r.value,
+              (long long)r.expectedValue, isCorrect(r) ? "true" : "false",
+              r.outOfMemory ? "true" : "false", r.instancesPerSecond);
+    }
+    fprintf(file, "\n  ]\n}\n");
+    return;
+  }
+
+  if (options.format == "csv") {
+    fprintf(file, "solver,class,n,capacity,trials,min_ns,median_ns,p95_ns,"
+                  "value,expected_value,correct,out_of_memory,"
+                  "instances_per_second\n");
+    for (Result const &r : results) {
+      fprintf(file, "%s,%s,%d,%lld,%u,%lld,%lld,%lld,%lld,%lld,%d,%d,%.3f\n",
+              r.solver.c_str(), instanceClassName(r.instanceClass), r.size,
+              (long long)r.capacity, r.trials, (long long)r.minNs,
+              (long long)r.medianNs, (long long)r.p95Ns, (long long)r.value,
+              (long long)r.expectedValue, isCorrect(r), r.outOfMemory,
+              r.instancesPerSecond);
+    }
+    return;
+  }
+
+  if (options.largest > 0) {
+    fprintf(file, "Solved in %g seconds\n--------------------\n",
+            options.largest);
+    for (Result const &r : results) {
+      fprintf(file, "%-10s %-28s Solved n = %-8d in %.3f seconds\n",
+              (r.solver + ":").c_str(), instanceClassName(r.instanceClass),
+              r.size, r.medianNs / 1e9);
+    }
+    return;
+  }
+
+  fprintf(file, "%-10s %-28s %8s %12s %12s %12s %12s  %s\n", "solver",
+          "class", "n", "min ms", "median ms", "p95 ms", "instances/s",
+          "check");
+  for (Result const &r : results) {
+    char const *check = "ok";
+
+    if (r.outOfMemory) {
+      check = "OUT OF MEMORY";
+    } else if (!isCorrect(r)) {
+      check = "WRONG VALUE";
+    } else if (r.expectedValue == INVALID_VALUE) {
+      check = "unchecked";
+    }
+
+    fprintf(file, "%-10s %-28s %8d %12.3f %12.3f %12.3f %12.1f  %s\n",
+            r.solver.c_str(), instanceClassName(r.instanceClass), r.size,
+            r.minNs / 1e6, r.medianNs / 1e6, r.p95Ns / 1e6,
+            r.instancesPerSecond, check);
+  }
+}
+
+int main(int argc, char *argv[]) {
+
+  Options options = parseOptions(argc, argv);
+
+  // Make allocations past the memory limit fail, rather than have the
+  // system kill the benchmark, so that a solver running out of memory is
+  // just a failed run. RLIMIT_DATA counts the heap and private mappings but
+  // not reserved address space, which sanitizers reserve a lot of. Only the
+  // soft limit is lowered.
+  if (options.memoryLimit > 0) {
+    struct rlimit limit;
+    getrlimit(RLIMIT_DATA, &limit);
+    rlim_t bytes = (rlim_t)options.memoryLimit << 20;
+    limit.rlim_cur = limit.rlim_max == RLIM_INFINITY
+                         ? bytes
+                         : std::min(bytes, limit.rlim_max);
+    if (setrlimit(RLIMIT_DATA, &limit) != 0) {
+      printf("Cannot limit memory: %s\n", strerror(errno));
+      exit(1);
+    }
+  }
+
+  std::vector<Result> results;
+
+  if (options.largest > 0) {
+    for (INSTANCE_CLASS instanceClass : options.classes) {
+      for (auto const &solver : options.solvers) {
+        results.push_back(findLargest(options, solver, instanceClass));
+      }
+    }
+  } else {
+    results = sweep(options);
+  }
+
+  FILE *file = stdout;
+
+  if (!options.output.empty()) {
+    file = fopen(options.output.c_str(), "w");
+    if (file == NULL) {
+      printf("Cannot write %s\n", options.output.c_str());
+      exit(1);
+    }
+  }
+
+  write(file, options, results);
+
+  if (file != stdout) {
+    fclose(file);
+  }
+
+  bool allCorrect = true;
+  for (Result const &r : results) {
+    allCorrect &= isCorrect(r);
+  }
+  return allCorrect ? 0 : 2;
+}
@@ -0,0 +1,169 @@
+//===-- client.cpp - 0/1 Knapsack Problem solver client -------------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackClient program, which sends instance files
+/// to a KnapsackServer and prints its solutions.
+///
+/// Every file is sent before any response is read, and a thread reads the
+/// responses as they come, so the server solves the files in parallel.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackInstanceFile.h"
+#include "KnapsackProtocol.h"
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Options {
+  std::string socketPath;
+  REQUEST_SOLVER solver = RQ_CORE;
+  uint32_t budgetMicroseconds = 0;
+  /// Whether to print the taken items
+  bool items = false;
+  std::vector<std::string> files;
+};
+
+static char const *const statusNames[] = {"solved", "invalid",
+                                          "out of memory"};
+
+static void usage(char const *program) {
+  printf("Usage: %s --socket PATH [options] FILE...\n"
+         "  --socket PATH    the server's Unix domain socket\n"
+         "  --solver S       core, dp or bb (default: core)\n"
+         "  --budget-us US   bb's time budget, in microseconds (default: the "
+         "server's)\n"
+         "  --items          print the numbers of the taken items\n",
+         program);
+}
+
+static Options parseOptions(int argc, char *argv[]) {
+  Options options;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string option = argv[i];
+
+    if (option == "--help" || option == "-h") {
+      usage(argv[0]);
+      exit(0);
+    }
+    if (option == "--items") {
+      options.items = true;
+      continue;
+    }
+    if (option.compare(0, 2, "--") != 0) {
+      options.files.push_back(option);
+      continue;
+    }
+    if (i + 1 == argc) {
+      printf("Missing the value of %s\n", option.c_str());
+      exit(1);
+    }
+    char const *value = argv[++i];
+
+    if (option == "--socket") {
+      options.socketPath = value;
+    } else if (option == "--solver") {
+      if (!findRequestSolver(value, options.solver)) {
+        printf("Unknown solver %s\n", value);
+        exit(1);
+      }
+    } else if (option == "--budget-us") {
+      options.budgetMicroseconds = strtoul(value, NULL, 10);
+    } else {
+      printf("Unknown option %s\n", option.c_str());
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+
+  if (options.socketPath.empty() || options.files.empty()) {
+    usage(argv[0]);
+    exit(1);
+  }
+  return options;
+}
+
+int main(int argc, char *argv[]) {
+  Options options = parseOptions(argc, argv);
+  KnapsackInstanceFile instanceFile;
+  std::vector<std::unique_ptr<KnapsackInstance>> instances;
+
+  for (auto const &file : options.files) {
+    instances.push_back(instanceFile.Read(file));
+    if (instances.back() == nullptr) {
+      printf("%s\n", instanceFile.GetError().c_str());
+      return 1;
+    }
+  }
+
+  std::string error;
+  int fd = connectToServer(options.socketPath, error);
+  if (fd < 0) {
+    printf("%s\n", error.c_str());
+    return 1;
+  }
+  KnapsackStream stream(fd, fd, true);
+
+  // Read while sending, so that neither end waits on a full socket
+  std::vector<KnapsackResponse> responses(instances.size());
+  size_t received = 0;
+  std::thread reader([&] {
+    KnapsackResponse response;
+    while (received < responses.size() && stream.ReadResponse(response) &&
+           response.header.id < responses.size()) {
+      responses[response.header.id] = response;
+      ++received;
+    }
+  });
+
+  for (size_t i = 0; i < instances.size(); ++i) {
+    KnapsackRequestHeader header = {};
+    header.solver = options.solver;
+    header.id = i;
+    header.budgetMicroseconds = options.budgetMicroseconds;
+    if (!stream.WriteRequest(header, *instances[i])) {
+      break;
+    }
+  }
+  stream.CloseWriting();
+  reader.join();
+
+  if (received < responses.size()) {
+    printf("The server answered %zu of %zu requests\n", received,
+           responses.size());
+    return 1;
+  }
+
+  for (size_t i = 0; i < responses.size(); ++i) {
+    KnapsackResponseHeader const &header = responses[i].header;
+
+    printf("%s: ", options.files[i].c_str());
+    if (header.status != RS_SOLVED) {
+      printf("%s\n", header.status <= RS_OUT_OF_MEMORY
+                         ? statusNames[header.status]
+                         : "unknown status");
+      continue;
+    }
+    printf("value %lld", (long long)header.value);
+    if (header.upperBound != header.value) {
+      printf(", upper bound %lld", (long long)header.upperBound);
+    }
+    printf(", %.3f ms\n", header.nanoseconds / 1e6);
+
+    if (options.items) {
+      for (uint32_t itemNum = 1; itemNum <= header.itemCount; ++itemNum) {
+        if (responses[i].IsTaken(itemNum)) {
+          printf(" %u", itemNum);
+        }
+      }
+      printf("\n");
+    }
+  }
+  return 0;
+}
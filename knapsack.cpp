@@ -9,179 +9,39 @@
 //===----------------------------------------------------------------------===//
 
 #include "knapsack.h"
-#include "KnapsackBBSolver.h"
-#include "KnapsackBTSolver.h"
-#include "KnapsackDPSolver.h"
-#include "Time.h"
+#include <algorithm>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
 #include <string>
-#include <sys/timeb.h>
-#include <time.h>
-
-#define TIMEB struct timeb
-#define FTIME ftime
-#define UDT_TIME long
-#define MAX_SIZE_TO_PRINT 50
-
-UDT_TIME gRefTime = 0;
-
-UDT_TIME GetMilliSecondTime(TIMEB timeBuf);
-void SetTime(void);
-UDT_TIME GetTime(void);
-
-int main(int argc, char *argv[]) {
-  UDT_TIME time, BFTime;
-  float speedup;
-  int itemCnt;
-  KnapsackInstance *inst;          // a Knapsack instance object
-  KnapsackDPSolver DPSolver;       // dynamic programming solver
-  KnapsackBFSolver BFSolver;       // brute-force solver
-  KnapsackBTSolver BTSolver;       // backtracking solver
-  KnapsackBBSolver BBSolver1(UB1); // branch-and-bound solver with UB1
-  KnapsackBBSolver BBSolver2(UB2); // branch-and-bound solver with UB2
-  KnapsackBBSolver BBSolver3(UB3); // branch-and-bound solver with UB3
-  KnapsackSolution *DPSoln, *BFSoln, *BTSoln, *BBSoln1, *BBSoln2, *BBSoln3;
-
-  if (argc != 2) {
-    printf("Invalid Number of command-line arguments\n");
-    exit(1);
-  }
-  itemCnt = atoi(argv[1]);
-  if (itemCnt < 1) {
-    printf("Invalid number of items\n");
-    exit(1);
-  }
-
-  inst = new KnapsackInstance(itemCnt);
-  DPSoln = new KnapsackSolution(inst);
-  BFSoln = new KnapsackSolution(inst);
-  BTSoln = new KnapsackSolution(inst);
-  BBSoln1 = new KnapsackSolution(inst);
-  BBSoln2 = new KnapsackSolution(inst);
-  BBSoln3 = new KnapsackSolution(inst);
-
-  inst->Generate();
-  inst->Print();
-
-  SetTime();
-  DPSolver.Solve(inst, DPSoln);
-  time = GetTime();
-  printf(
-      "\n\nSolved using dynamic programming (DP) in %ld ms. Optimal value = %d",
-      time, DPSoln->GetValue());
-  if (itemCnt <= MAX_SIZE_TO_PRINT)
-    DPSoln->Print("Dynamic Programming Solution");
-
-  SetTime();
-  BFSolver.Solve(inst, BFSoln);
-  BFTime = time = GetTime();
-  printf("\n\nSolved using brute-force enumeration (BF) in %ld ms. Optimal "
-         "value = %d",
-         time, BFSoln->GetValue());
-  if (itemCnt <= MAX_SIZE_TO_PRINT)
-    BFSoln->Print("Brute-Force Solution");
-  if (*DPSoln == *BFSoln)
-    printf("\nSUCCESS: DP and BF solutions match");
-  else
-    printf("\nERROR: DP and BF solutions mismatch");
-
-  SetTime();
-  BTSolver.Solve(inst, BTSoln);
-  time = GetTime();
-  printf("\n\nSolved using backtracking (BT) in %ld ms. Optimal value = %d",
-         time, BTSoln->GetValue());
-  if (itemCnt <= MAX_SIZE_TO_PRINT)
-    BTSoln->Print("Backtracking Solution");
-  if (*BFSoln == *BTSoln)
-    printf("\nSUCCESS: BF and BT solutions match");
-  else
-    printf("\nERROR: BF and BT solutions mismatch");
-  speedup = time == 0 ? 0 : 100.0 * (BFTime - time) / (float)BFTime;
-  printf("\nSpeedup of BT relative to BF is %.2f%c", speedup, '%');
-
-  SetTime();
-  BBSolver1.Solve(inst, BBSoln1);
-  time = GetTime();
-  printf("\n\nSolved using branch-and-bound (BB) with UB1 in %ld ms. Optimal "
-         "value = %d",
-         time, BBSoln1->GetValue());
-  if (itemCnt <= MAX_SIZE_TO_PRINT)
-    BBSoln1->Print("BB-UB1 Solution");
-  if (*BFSoln == *BBSoln1)
-    printf("\nSUCCESS: BF and BB-UB1 solutions match");
-  else
-    printf("\nERROR: BF and BB-UB1 solutions mismatch");
-  speedup = time == 0 ? 0 : 100.0 * (BFTime - time) / (float)BFTime;
-  printf("\nSpeedup of BB-UB1 relative to BF is %.2f%c", speedup, '%');
-
-  SetTime();
-  BBSolver2.Solve(inst, BBSoln2);
-  time = GetTime();
-  printf("\n\nSolved using branch-and-bound (BB) with UB2 in %ld ms. Optimal "
-         "value = %d",
-         time, BBSoln2->GetValue());
-  if (itemCnt <= MAX_SIZE_TO_PRINT)
-    BBSoln2->Print("BB-UB2 Solution");
-  if (*BFSoln == *BBSoln2)
-    printf("\nSUCCESS: BF and BB-UB2 solutions match");
-  else
-    printf("\nERROR: BF and BB-UB2 solutions mismatch");
-  speedup = time == 0 ? 0 : 100.0 * (BFTime - time) / (float)BFTime;
-  printf("\nSpeedup of BB-UB2 relative to BF is %.2f%c", speedup, '%');
-
-  SetTime();
-  BBSolver3.Solve(inst, BBSoln3);
-  time = GetTime();
-  printf("\n\nSolved using branch-and-bound (BB) with UB3 in %ld ms. Optimal "
-         "value = %d",
-         time, BBSoln3->GetValue());
-  if (itemCnt <= MAX_SIZE_TO_PRINT)
-    BBSoln3->Print("BB-UB3 Solution");
-  if (*BFSoln == *BBSoln3)
-    printf("\nSUCCESS: BF and BB-UB3 solutions match");
-  else
-    printf("\nERROR: BF and BB-UB3 solutions mismatch");
-  speedup = time == 0 ? 0 : 100.0 * (BFTime - time) / (float)BFTime;
-  printf("\nSpeedup of BB-UB3 relative to BF is %.2f%c", speedup, '%');
-
-  delete inst;
-  delete DPSoln;
-  delete BFSoln;
-  delete BTSoln;
-  delete BBSoln1;
-  delete BBSoln2;
-  delete BBSoln3;
-
-  printf("\n\nProgram Completed Successfully\n");
-
-  return 0;
-}
 
 //===-- KnapsackInstance --------------------------------------------------===//
 
-KnapsackInstance::KnapsackInstance(int itemCnt_) {
+template <typename T>
+BasicKnapsackInstance<T>::BasicKnapsackInstance(int itemCnt_) {
   itemCnt = itemCnt_;
-
-  weights = new int[itemCnt + 1];
-  values = new int[itemCnt + 1];
   cap = 0;
-}
 
-KnapsackInstance::~KnapsackInstance() {
-  delete[] weights;
-  delete[] values;
-}
+  // Round each array up to whole cache lines, and allocate one line more so
+  // that the first array can be moved up to a line boundary.
+  size_t lineItems = cacheLine / sizeof(T);
+  size_t stride = (itemCnt + lineItems - 1) / lineItems * lineItems;
 
-void KnapsackInstance::Generate() {
-  int i, wghtSum;
+  T *arrays = new T[2 * stride + lineItems]();
+  storage.reset(arrays, std::default_delete<T[]>());
 
-  weights[0] = 0;
-  values[0] = 0;
+  uintptr_t address = reinterpret_cast<uintptr_t>(arrays);
+  size_t offset = (cacheLine - address % cacheLine) % cacheLine / sizeof(T);
+
+  weights = arrays + offset;
+  values = weights + stride;
+}
+
+template <typename T> void BasicKnapsackInstance<T>::Generate() {
+  int i;
+  int64_t wghtSum;
 
   wghtSum = 0;
-  for (i = 1; i <= itemCnt; i++) {
+  for (i = 0; i < itemCnt; i++) {
     weights[i] = rand() % 100 + 1;
     values[i] = weights[i] + 10;
     wghtSum += weights[i];
@@ -189,76 +49,60 @@ void KnapsackInstance::Generate() {
   cap = wghtSum / 2;
 }
 
-int KnapsackInstance::GetItemCnt() { return itemCnt; }
+template <typename T> int64_t BasicKnapsackInstance<T>::GetWeightSum() const {
+  int64_t sum = 0;
 
-int KnapsackInstance::GetItemWeight(int itemNum) { return weights[itemNum]; }
+  for (T weight : GetWeights()) {
+    sum += weight;
+  }
+  return sum;
+}
 
-int KnapsackInstance::GetItemValue(int itemNum) { return values[itemNum]; }
+template <typename T> int64_t BasicKnapsackInstance<T>::GetValueSum() const {
+  int64_t sum = 0;
 
-int KnapsackInstance::GetCapacity() { return cap; }
+  for (T value : GetValues()) {
+    sum += value;
+  }
+  return sum;
+}
 
-void KnapsackInstance::Print() {
+template <typename T> void BasicKnapsackInstance<T>::Print() const {
   int i;
 
-  printf("Number of items = %d, Capacity = %d\n", itemCnt, cap);
+  printf("Number of items = %d, Capacity = %lld\n", itemCnt, (long long)cap);
   printf("Weights: ");
-  for (i = 1; i <= itemCnt; i++) {
-    printf("%d ", weights[i]);
+  for (i = 0; i < itemCnt; i++) {
+    printf("%lld ", (long long)weights[i]);
   }
   printf("\nValues: ");
-  for (i = 1; i <= itemCnt; i++) {
-    printf("%d ", values[i]);
+  for (i = 0; i < itemCnt; i++) {
+    printf("%lld ", (long long)values[i]);
   }
   printf("\n");
 }
 
+template class BasicKnapsackInstance<int16_t>;
+template class BasicKnapsackInstance<int32_t>;
+template class BasicKnapsackInstance<int64_t>;
+
 //===-- KnapsackSolution --------------------------------------------------===//
 
 KnapsackSolution::KnapsackSolution(KnapsackInstance *inst_)
-    : isTaken(inst_->GetItemCnt() + 1) {
-  int i, itemCnt = inst_->GetItemCnt();
-
+    : takenWords((inst_->GetItemCnt() + 63) / 64) {
   inst = inst_;
+  weight = 0;
   value = 0;
-
-  for (i = 1; i <= itemCnt; i++) {
-    isTaken[i] = false;
-  }
-}
-
-bool KnapsackSolution::operator==(KnapsackSolution &otherSoln) {
-  return value == otherSoln.value;
 }
 
-void KnapsackSolution::TakeItem(int itemNum) { isTaken[itemNum] = true; }
-
-void KnapsackSolution::DontTakeItem(int itemNum) { isTaken[itemNum] = false; }
-
-int KnapsackSolution::ComputeValue() {
-  int i, itemCnt = inst->GetItemCnt(), weight = 0;
-
-  value = 0;
-  for (i = 1; i <= itemCnt; i++) {
-    if (isTaken[i] == true) {
-      weight += inst->GetItemWeight(i);
-      if (weight > inst->GetCapacity()) {
-        value = INVALID_VALUE;
-        break;
-      }
-      value += inst->GetItemValue(i);
-    }
-  }
-  return value;
+bool KnapsackSolution::operator==(KnapsackSolution const &otherSoln) const {
+  return takenWords == otherSoln.takenWords;
 }
 
-int KnapsackSolution::GetValue() { return value; }
-
 void KnapsackSolution::Copy(KnapsackSolution *otherSoln) {
-  int i, itemCnt = inst->GetItemCnt();
-
-  for (i = 1; i <= itemCnt; i++) {
-    isTaken[i] = otherSoln->isTaken[i];
-  }
+  std::copy(otherSoln->takenWords.begin(), otherSoln->takenWords.end(),
+            takenWords.begin());
+  weight = otherSoln->weight;
   value = otherSoln->value;
 }
 
@@ -267,15 +111,15 @@ void KnapsackSolution::Print(std::string title) {
 
   printf("\n%s: ", title.c_str());
   for (i = 1; i <= itemCnt; i++) {
-    if (isTaken[i] == true)
+    if (IsTaken(i))
       printf("%d ", i);
   }
-  printf("\nValue = %d\n", value);
+  printf("\nValue = %lld\n", (long long)GetValue());
 }
 
 //===-- KnapsackBFSolver --------------------------------------------------===//
 
-KnapsackBFSolver::KnapsackBFSolver() : maxDuration(std::chrono::seconds(10)) {
+KnapsackBFSolver::KnapsackBFSolver() {
   crntSoln = NULL;
 }
 
@@ -286,19 +130,25 @@ KnapsackBFSolver::~KnapsackBFSolver() {
 
 void KnapsackBFSolver::Solve(KnapsackInstance *inst_, KnapsackSolution *soln_) {
 
-  startTime = getTime();
+  deadline.Start();
+  countdown.Reset(deadline);
   inst = inst_;
   bestSoln = soln_;
+  if (crntSoln != NULL)
+    delete crntSoln;
   crntSoln = new KnapsackSolution(inst);
+  stats.Start(inst->GetItemCnt());
   FindSolns(1);
 }
 
 void KnapsackBFSolver::FindSolns(int itemNum) {
   int itemCnt = inst->GetItemCnt();
 
-  auto duration = timeSince(startTime);
+  stats.Node(itemNum - 1);
 
-  if (itemNum == itemCnt + 1 || duration > maxDuration) {
+  if (itemNum == itemCnt + 1 || countdown.Expired()) {
+    if (itemNum == itemCnt + 1)
+      stats.Leaf(itemNum - 1);
     CheckCrntSoln();
     return;
   }
@@ -309,7 +159,7 @@ void KnapsackBFSolver::FindSolns(int itemNum) {
 }
 
 void KnapsackBFSolver::CheckCrntSoln() {
-  int crntVal = crntSoln->ComputeValue();
+  int64_t crntVal = crntSoln->ComputeValue();
 
 #ifdef KNAPSACK_DEBUG
   printf("\nChecking solution ");
@@ -320,11 +170,10 @@ void KnapsackBFSolver::CheckCrntSoln() {
     return;
 
   // The first solution is initially the best solution
-  if (bestSoln->GetValue() == INVALID_VALUE)
+  if (bestSoln->GetValue() == INVALID_VALUE ||
+      crntVal > bestSoln->GetValue()) {
     bestSoln->Copy(crntSoln);
-  else {
-    if (crntVal > bestSoln->GetValue())
-      bestSoln->Copy(crntSoln);
+    stats.Improve(crntVal);
   }
 }
 
@@ -336,32 +185,3 @@ void KnapsackBFSolver::CheckCrntSoln() {
 // and produces an object of class KnapsackSolution as output.
 // See how the given KnapsackBFSolver::Solve() writes its result into the
 // KnapsackSolution object and make the solvers that you write do the same.
-
-//===-- Time related functions --------------------------------------------===//
-
-UDT_TIME GetCurrentTime(void) {
-  UDT_TIME crntTime = 0;
-
-  TIMEB timeBuf;
-  FTIME(&timeBuf);
-  crntTime = GetMilliSecondTime(timeBuf);
-
-  return crntTime;
-}
-
-void SetTime(void) { gRefTime = GetCurrentTime(); }
-
-UDT_TIME GetTime(void) {
-  UDT_TIME crntTime = GetCurrentTime();
-
-  return (crntTime - gRefTime);
-}
-
-UDT_TIME GetMilliSecondTime(TIMEB timeBuf) {
-  UDT_TIME mliScndTime;
-
-  mliScndTime = timeBuf.time;
-  mliScndTime *= 1000;
-  mliScndTime += timeBuf.millitm;
-  return mliScndTime;
-}
@@ -11,55 +11,245 @@
 #ifndef KNAPSACK_H
 #define KNAPSACK_H
 
+#include "KnapsackDeadline.h"
+#include "KnapsackSearchStats.h"
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 //#define KNAPSACK_DEBUG
 
 #define INVALID_VALUE -1
 
-enum UPPER_BOUND { UB1, UB2, UB3 };
+/// Selects the bound KnapsackBBSolver prunes with. UB1 is the total value of
+/// the undecided items, UB2 the total value of those that fit on their own,
+/// and UB3 the Dantzig bound of the fractional knapsack. UB4 is the
+/// Martello-Toth bound U2, which decides the break item of the fractional
+/// knapsack both ways. UB5 enumerates both decisions of the break item to a
+/// configurable depth, bounding each branch with UB3.
+enum UPPER_BOUND { UB1, UB2, UB3, UB4, UB5 };
+
+/// Selects the order in which KnapsackBBSolver explores the search tree.
+/// BB_DEPTH_FIRST recurses through the tree with the chosen upper bound.
+/// BB_BEST_FIRST always expands the open node with the highest bound, using
+/// UB3 unless UB4 or UB5 is chosen. BB_HYBRID takes the open node with the
+/// highest bound and dives from it depth-first, leaving the other branches
+/// open.
+enum BB_SEARCH { BB_DEPTH_FIRST, BB_BEST_FIRST, BB_HYBRID };
+
+/// Selects how KnapsackDPSolver stores the table it backtracks through.
+/// DP_FULL_TABLE keeps every row of the table. DP_LINEAR_MEMORY keeps only
+/// O(capacity) cells and recovers the taken items by divide-and-conquer.
+/// DP_BIT_PACKED keeps one row of values plus one take/skip bit per cell.
+/// DP_BY_VALUE indexes the table by value instead of capacity, storing the
+/// least weight that reaches each value, with one take/skip bit per cell.
+/// DP_AUTO uses DP_BY_VALUE when the values sum to less than the capacity, and
+/// DP_BIT_PACKED otherwise.
+enum DP_MODE {
+  DP_FULL_TABLE,
+  DP_LINEAR_MEMORY,
+  DP_BIT_PACKED,
+  DP_BY_VALUE,
+  DP_AUTO
+};
+
+/// Selects the family of instances KnapsackGenerator draws, following
+/// Pisinger's classes. With weights drawn from [1, R]:
+/// IC_UNCORRELATED draws values from [1, R] as well.
+/// IC_WEAKLY_CORRELATED draws each value within R/10 of its weight.
+/// IC_STRONGLY_CORRELATED sets each value to its weight plus R/10.
+/// IC_INVERSE_STRONGLY_CORRELATED draws values from [1, R] and sets each
+/// weight to its value plus R/10.
+/// IC_ALMOST_STRONGLY_CORRELATED draws each value within R/500 of its weight
+/// plus R/10.
+/// IC_SUBSET_SUM sets each value to its weight.
+/// IC_SPANNER draws a few items from another class, scales them down, and
+/// makes every item a random multiple of one of them.
+/// IC_PROFIT_CEILING rounds each weight up to a multiple of 3 for its value.
+enum INSTANCE_CLASS {
+  IC_UNCORRELATED,
+  IC_WEAKLY_CORRELATED,
+  IC_STRONGLY_CORRELATED,
+  IC_INVERSE_STRONGLY_CORRELATED,
+  IC_ALMOST_STRONGLY_CORRELATED,
+  IC_SUBSET_SUM,
+  IC_SPANNER,
+  IC_PROFIT_CEILING
+};
+
+/// Selects the solver a KnapsackServer request is solved with. RQ_CORE and
+/// RQ_DP solve exactly, with KnapsackCoreSolver and with KnapsackDPSolver in
+/// DP_AUTO mode. RQ_BB solves with KnapsackBBSolver and UB3 within the
+/// request's time budget, answering with the best solution it found and the
+/// upper bound it proved.
+enum REQUEST_SOLVER { RQ_CORE, RQ_DP, RQ_BB };
+
+/// Says how a KnapsackServer request went. RS_INVALID is for requests naming
+/// no known solver, whose capacity or items are negative or do not fit in
+/// 32 bits, or, for RQ_DP, whose values add up to more than UINT32_MAX.
+enum RESPONSE_STATUS { RS_SOLVED, RS_INVALID, RS_OUT_OF_MEMORY };
 
 //===-- Knapsack Instance -------------------------------------------------===//
 
-class KnapsackInstance {
+/// A view of a contiguous array, in the manner of C++20's std::span, through
+/// which solvers read an instance's items without a call per item.
+template <typename T> class KnapsackSpan {
+private:
+  T *first = nullptr;
+  size_t count = 0;
+
+public:
+  constexpr KnapsackSpan() = default;
+  constexpr KnapsackSpan(T *first, size_t count) : first(first), count(count) {}
+
+  constexpr T *data() const { return first; }
+  constexpr size_t size() const { return count; }
+  constexpr bool empty() const { return count == 0; }
+  constexpr T &operator[](size_t i) const { return first[i]; }
+  constexpr T *begin() const { return first; }
+  constexpr T *end() const { return first + count; }
+};
+
+/// The items and capacity of a 0/1 knapsack problem.
+///
+/// Weights and values are kept in two separate arrays, each starting on a
+/// cache line and padded with zeros to a whole number of cache lines, so
+/// that a solver scanning one of them reads nothing else and vector loads
+/// never run off the end. Items are numbered from 1, and item i is at index
+/// i-1 of the spans.
+///
+/// \param T The type of the weights, values and capacity: int16_t, int32_t
+/// or int64_t. Narrow types fit more items per cache line. Sums over the
+/// items are always int64_t.
+template <typename T> class BasicKnapsackInstance {
+  static_assert(std::is_integral<T>::value && std::is_signed<T>::value,
+                "weights and values must be signed integers");
+
+public:
+  using Number = T;
+
 private:
-  int itemCnt;  // Number of items
-  int cap;      // The capacity
-  int *weights; // An array of weights
-  int *values;  // An array of values
+  static size_t const cacheLine = 64;
+
+  int itemCnt; // Number of items
+  T cap;       // The capacity
+  /// Keeps the arrays alive: either an allocation or a mapped file
+  std::shared_ptr<void> storage;
+  T *weights; // An array of weights, 64-byte aligned
+  T *values;  // An array of values, 64-byte aligned
 
 public:
-  KnapsackInstance(int itemCnt_);
-  ~KnapsackInstance();
+  explicit BasicKnapsackInstance(int itemCnt_);
+
+  /// Use arrays that `storage` keeps alive, such as those of a mapped file,
+  /// rather than allocating them. Each array must be 64-byte aligned and
+  /// padded with zeros to a whole number of cache lines.
+  BasicKnapsackInstance(int itemCnt_, T capacity, T *weights_, T *values_,
+                        std::shared_ptr<void> storage_)
+      : itemCnt(itemCnt_), cap(capacity), storage(std::move(storage_)),
+        weights(weights_), values(values_) {}
 
   void Generate();
 
-  int GetItemCnt();
-  int GetItemWeight(int itemNum);
-  int GetItemValue(int itemNum);
-  int GetCapacity();
-  void Print();
+  int GetItemCnt() const { return itemCnt; }
+  T GetItemWeight(int itemNum) const { return weights[itemNum - 1]; }
+  T GetItemValue(int itemNum) const { return values[itemNum - 1]; }
+  T GetCapacity() const { return cap; }
+
+  KnapsackSpan<T const> GetWeights() const {
+    return {weights, (size_t)itemCnt};
+  }
+  KnapsackSpan<T const> GetValues() const { return {values, (size_t)itemCnt}; }
+
+  int64_t GetWeightSum() const;
+  int64_t GetValueSum() const;
+
+  void SetItem(int itemNum, T weight, T value) {
+    weights[itemNum - 1] = weight;
+    values[itemNum - 1] = value;
+  }
+  void SetCapacity(T capacity) { cap = capacity; }
+  void Print() const;
 };
 
+extern template class BasicKnapsackInstance<int16_t>;
+extern template class BasicKnapsackInstance<int32_t>;
+extern template class BasicKnapsackInstance<int64_t>;
+
+/// The instance every solver takes
+using KnapsackInstance = BasicKnapsackInstance<int32_t>;
+
 //===-- Knapsack Solution -------------------------------------------------===//
 
+/// A set of items taken from a KnapsackInstance.
+///
+/// The taken items are kept as one bit per item, packed into 64-bit words,
+/// and their weight and value are updated as items are taken and dropped.
+/// Getting the value and copying a solution therefore never rescan the
+/// items.
 class KnapsackSolution {
 private:
-  std::vector<bool> isTaken;
-  int value;
+  /// Bit (i-1) % 64 of word (i-1) / 64 is set if item i is taken
+  std::vector<uint64_t> takenWords;
+  int64_t weight;
+  int64_t value;
   KnapsackInstance *inst;
 
 public:
   KnapsackSolution(KnapsackInstance *inst);
 
-  bool operator==(KnapsackSolution &otherSoln);
-  void TakeItem(int itemNum);
-  void DontTakeItem(int itemNum);
-  int ComputeValue();
-  int GetValue();
+  /// Compare the sets of taken items.
+  bool operator==(KnapsackSolution const &otherSoln) const;
+  bool operator!=(KnapsackSolution const &otherSoln) const {
+    return !(*this == otherSoln);
+  }
+
+  void TakeItem(int itemNum) {
+    uint64_t &word = takenWords[(itemNum - 1) / 64];
+    uint64_t bit = uint64_t(1) << (itemNum - 1) % 64;
+
+    if (!(word & bit)) {
+      word |= bit;
+      weight += inst->GetItemWeight(itemNum);
+      value += inst->GetItemValue(itemNum);
+    }
+  }
+
+  void DontTakeItem(int itemNum) {
+    uint64_t &word = takenWords[(itemNum - 1) / 64];
+    uint64_t bit = uint64_t(1) << (itemNum - 1) % 64;
+
+    if (word & bit) {
+      word &= ~bit;
+      weight -= inst->GetItemWeight(itemNum);
+      value -= inst->GetItemValue(itemNum);
+    }
+  }
+
+  bool IsTaken(int itemNum) const {
+    return takenWords[(itemNum - 1) / 64] >> (itemNum - 1) % 64 & 1;
+  }
+
+  /// Get the value of the taken items, or INVALID_VALUE if they do not fit.
+  /// The value is kept up to date, so this is the same as GetValue().
+  int64_t ComputeValue() const { return GetValue(); }
+
+  /// Get the value of the taken items, or INVALID_VALUE if they do not fit.
+  int64_t GetValue() const {
+    return weight > inst->GetCapacity() ? INVALID_VALUE : value;
+  }
+
+  /// Get the total weight of the taken items.
+  int64_t GetWeight() const { return weight; }
+
   void Print(std::string str);
+
+  /// Take exactly the items another solution of the same instance takes.
   void Copy(KnapsackSolution *otherSoln);
 };
 
@@ -70,8 +260,9 @@ protected:
   KnapsackInstance *inst;
   KnapsackSolution *crntSoln;
   KnapsackSolution *bestSoln;
-  std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
-  std::chrono::duration<uint32_t> maxDuration;
+  KnapsackDeadline deadline;
+  KnapsackDeadline::Countdown countdown;
+  KnapsackSearchStats stats;
 
   virtual void FindSolns(int itemNum);
   virtual void CheckCrntSoln();
@@ -81,6 +272,12 @@ public:
   ~KnapsackBFSolver();
 
   virtual void Solve(KnapsackInstance *inst, KnapsackSolution *soln);
+
+  /// Get the limits on every Solve(), or cancel a running one.
+  KnapsackDeadline &GetDeadline() { return deadline; }
+
+  /// Get what the last Solve() did at each depth of the tree.
+  KnapsackSearchStats const &GetStats() const { return stats; }
 };
 
 #endif // KNAPSACK_H
\ No newline at end of file
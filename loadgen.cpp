@@ -0,0 +1,296 @@
+//===-- loadgen.cpp - 0/1 Knapsack Problem solver server load -------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackLoad program, which sends generated
+/// instances to a KnapsackServer as fast as it answers them, and reports the
+/// solves per second and the latency of the requests.
+///
+/// Each connection keeps up to --window requests in flight, sending a new
+/// one as each response comes back. A request's latency runs from sending
+/// it to receiving its response, so it includes the time spent waiting in
+/// the server's queue, and the tail latencies show how much requests wait
+/// when the server is saturated.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackGenerator.h"
+#include "KnapsackProtocol.h"
+#include "Time.h"
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Options {
+  std::string socketPath;
+  unsigned requests = 10000;
+  unsigned connections = 1;
+  /// The most requests in flight on each connection
+  unsigned window = 64;
+  int size = 100;
+  INSTANCE_CLASS instanceClass = IC_STRONGLY_CORRELATED;
+  int64_t range = 1000;
+  uint64_t seed = 1;
+  /// How many different instances to send, in turn
+  unsigned instances = 64;
+  REQUEST_SOLVER solver = RQ_CORE;
+  uint32_t budgetMicroseconds = 0;
+};
+
+/// What one connection saw
+struct ConnectionResult {
+  /// The latency of every answered request, in nanoseconds
+  std::vector<int64_t> latencies;
+  /// The server's time solving every solved request, in nanoseconds
+  uint64_t solveNanoseconds = 0;
+  unsigned solved = 0, failed = 0;
+  bool lost = false;
+};
+
+static void usage(char const *program) {
+  printf("Usage: %s --socket PATH [options]\n"
+         "  --socket PATH     the server's Unix domain socket\n"
+         "  --requests N      requests to send in all (default: 10000)\n"
+         "  --connections C   connections sending at once (default: 1)\n"
+         "  --window W        most requests in flight per connection "
+         "(default: 64)\n"
+         "  --size N          items per instance (default: 100)\n"
+         "  --class C         instance class (default: "
+         "strongly-correlated)\n"
+         "  --range R         largest weight drawn (default: 1000)\n"
+         "  --seed S          generator seed (default: 1)\n"
+         "  --instances K     different instances to send, with consecutive "
+         "seeds\n"
+         "                    (default: 64)\n"
+         "  --solver S        core, dp or bb (default: core)\n"
+         "  --budget-us US    bb's time budget, in microseconds (default: "
+         "the server's)\n",
+         program);
+}
+
+static Options parseOptions(int argc, char *argv[]) {
+  Options options;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string option = argv[i];
+
+    if (option == "--help" || option == "-h") {
+      usage(argv[0]);
+      exit(0);
+    }
+    if (i + 1 == argc) {
+      printf("Missing the value of %s\n", option.c_str());
+      exit(1);
+    }
+    char const *value = argv[++i];
+
+    if (option == "--socket") {
+      options.socketPath = value;
+    } else if (option == "--requests") {
+      options.requests = std::max(1, atoi(value));
+    } else if (option == "--connections") {
+      options.connections = std::max(1, atoi(value));
+    } else if (option == "--window") {
+      options.window = std::max(1, atoi(value));
+    } else if (option == "--size") {
+      options.size = std::max(1, atoi(value));
+    } else if (option == "--class") {
+      int c = IC_UNCORRELATED;
+      while (c <= IC_PROFIT_CEILING &&
+             std::string(value) != instanceClassName((INSTANCE_CLASS)c)) {
+        ++c;
+      }
+      if (c > IC_PROFIT_CEILING) {
+        printf("Unknown instance class %s\n", value);
+        exit(1);
+      }
+      options.instanceClass = (INSTANCE_CLASS)c;
+    } else if (option == "--range") {
+      options.range = atoll(value);
+    } else if (option == "--seed") {
+      options.seed = strtoull(value, NULL, 10);
+    } else if (option == "--instances") {
+      options.instances = std::max(1, atoi(value));
+    } else if (option == "--solver") {
+      if (!findRequestSolver(value, options.solver)) {
+        printf("Unknown solver %s\n", value);
+        exit(1);
+      }
+    } else if (option == "--budget-us") {
+      options.budgetMicroseconds = strtoul(value, NULL, 10);
+    } else {
+      printf("Unknown option %s\n", option.c_str());
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+
+  if (options.socketPath.empty()) {
+    usage(argv[0]);
+    exit(1);
+  }
+  return options;
+}
+
+/// Send `requestCount` requests on a new connection, keeping up to the
+/// window in flight.
+static void
+runConnection(Options const &options,
+              std::vector<std::unique_ptr<KnapsackInstance>> const &instances,
+              unsigned firstRequest, unsigned requestCount,
+              ConnectionResult &result) {
+
+  std::string error;
+  int fd = connectToServer(options.socketPath, error);
+  if (fd < 0) {
+    printf("%s\n", error.c_str());
+    result.lost = true;
+    return;
+  }
+  KnapsackStream stream(fd, fd, true);
+
+  std::vector<std::chrono::high_resolution_clock::time_point> sendTimes(
+      requestCount);
+  std::mutex mutex;
+  std::condition_variable windowOpen;
+  unsigned inFlight = 0;
+  bool readerDone = false;
+
+  std::thread reader([&] {
+    KnapsackResponse response;
+    unsigned received = 0;
+
+    while (received < requestCount && stream.ReadResponse(response)) {
+      uint64_t id = response.header.id - firstRequest;
+      if (id >= requestCount) {
+        break;
+      }
+      auto receiveTime = getTime();
+      if (response.header.status == RS_SOLVED) {
+        ++result.solved;
+        result.solveNanoseconds += response.header.nanoseconds;
+      } else {
+        ++result.failed;
+      }
+      ++received;
+
+      std::lock_guard<std::mutex> lock(mutex);
+      result.latencies.push_back(
+          std::chrono::nanoseconds(receiveTime - sendTimes[id]).count());
+      --inFlight;
+      windowOpen.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    result.lost = received < requestCount;
+    readerDone = true;
+    windowOpen.notify_one();
+  });
+
+  for (unsigned r = 0; r < requestCount; ++r) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      windowOpen.wait(
+          lock, [&] { return inFlight < options.window || readerDone; });
+      if (readerDone) {
+        break;
+      }
+      ++inFlight;
+      sendTimes[r] = getTime();
+    }
+
+    KnapsackRequestHeader header = {};
+    header.solver = options.solver;
+    header.id = firstRequest + r;
+    header.budgetMicroseconds = options.budgetMicroseconds;
+    if (!stream.WriteRequest(
+            header, *instances[(firstRequest + r) % instances.size()])) {
+      break;
+    }
+  }
+  stream.CloseWriting();
+  reader.join();
+}
+
+/// Get the p-th percentile of sorted latencies, in milliseconds.
+static double percentile(std::vector<int64_t> const &latencies, unsigned p) {
+  return latencies[(latencies.size() * p + 99) / 100 - 1] / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+  Options options = parseOptions(argc, argv);
+
+  signal(SIGPIPE, SIG_IGN);
+
+  std::vector<std::unique_ptr<KnapsackInstance>> instances;
+  KnapsackGenerator generator(options.instanceClass);
+  generator.SetRange(options.range);
+  for (unsigned i = 0; i < options.instances; ++i) {
+    instances.emplace_back(new KnapsackInstance(options.size));
+    generator.SetSeed(options.seed + i);
+    generator.Generate(instances.back().get());
+  }
+
+  std::vector<ConnectionResult> results(options.connections);
+  std::vector<std::thread> threads;
+  auto startTime = getTime();
+
+  unsigned firstRequest = 0;
+  for (unsigned c = 0; c < options.connections; ++c) {
+    // Share the requests out as evenly as they go
+    unsigned requestCount =
+        options.requests / options.connections +
+        (c < options.requests % options.connections ? 1 : 0);
+    threads.emplace_back(runConnection, std::cref(options),
+                         std::cref(instances), firstRequest, requestCount,
+                         std::ref(results[c]));
+    firstRequest += requestCount;
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  double seconds = timeSince(startTime).count();
+
+  std::vector<int64_t> latencies;
+  uint64_t solveNanoseconds = 0;
+  unsigned solved = 0, failed = 0;
+  bool lost = false;
+  for (auto const &result : results) {
+    latencies.insert(latencies.end(), result.latencies.begin(),
+                     result.latencies.end());
+    solveNanoseconds += result.solveNanoseconds;
+    solved += result.solved;
+    failed += result.failed;
+    lost = lost || result.lost;
+  }
+  if (latencies.empty()) {
+    printf("No requests were answered\n");
+    return 1;
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  printf("%u requests of %d items on %u connections, window %u\n",
+         (unsigned)latencies.size(), options.size, options.connections,
+         options.window);
+  printf("solved: %u, failed: %u, in %.3f s\n", solved, failed, seconds);
+  printf("throughput: %.0f solves/s\n", solved / seconds);
+  printf("latency (ms): p50 %.3f, p90 %.3f, p99 %.3f, max %.3f\n",
+         percentile(latencies, 50), percentile(latencies, 90),
+         percentile(latencies, 99), latencies.back() / 1e6);
+  printf("mean solve time (ms): %.3f\n",
+         solved > 0 ? solveNanoseconds / 1e6 / solved : 0.0);
+
+  if (lost) {
+    printf("Some requests were not answered\n");
+    return 1;
+  }
+  return 0;
+}
@@ -1,6 +1,588 @@
-#include <iostream>
+//===-- main.cpp - 0/1 Knapsack Problem solver driver ---------------------===//
+//
+// Authors: Ghassan Shobaki, Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the Knapsack program, which solves one 0/1 knapsack
+/// problem with every solver and checks that their solutions agree.
+//===----------------------------------------------------------------------===//
+
+#include "knapsack.h"
+#include "KnapsackBBSolver.h"
+#include "KnapsackBTSolver.h"
+#include "KnapsackCoreSolver.h"
+#include "KnapsackDPSolver.h"
+#include "KnapsackIncrementalDPSolver.h"
+#include "KnapsackInstanceFile.h"
+#include "KnapsackParallelBBSolver.h"
+#include "KnapsackParetoSolver.h"
+#include "KnapsackReduction.h"
+#include "Time.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/timeb.h>
+#include <thread>
+#include <time.h>
+
+#define TIMEB struct timeb
+#define FTIME ftime
+#define UDT_TIME long
+#define MAX_SIZE_TO_PRINT 50
+
+UDT_TIME gRefTime = 0;
+
+UDT_TIME GetMilliSecondTime(TIMEB timeBuf);
+void SetTime(void);
+UDT_TIME GetTime(void);
+void CheckLargeValues(void);
+
+int main(int argc, char *argv[]) {
+  UDT_TIME time, BFTime;
+  float speedup;
+  int itemCnt;
+  KnapsackInstance *inst;          // a Knapsack instance object
+  KnapsackInstanceFile InstanceFile; // reads and writes instance files
+  KnapsackDPSolver DPSolver;       // dynamic programming solver
+  KnapsackDPSolver DPLMSolver(DP_LINEAR_MEMORY); // linear-memory DP solver
+  KnapsackDPSolver DPBPSolver(DP_BIT_PACKED);    // bit-packed DP solver
+  KnapsackDPSolver DPMTSolver(DP_BIT_PACKED,      // multi-threaded DP solver
+                              std::thread::hardware_concurrency());
+  KnapsackDPSolver DPVSolver(DP_BY_VALUE);       // value-indexed DP solver
+  KnapsackDPSolver DPAutoSolver(DP_AUTO); // DP with the cheaper orientation
+  KnapsackIncrementalDPSolver DPIncSolver; // DP adding one item at a time
+  KnapsackParetoSolver ParetoSolver; // sparse Pareto-frontier DP solver
+  KnapsackCoreSolver CoreSolver;   // expanding-core solver
+  // DP and branch-and-bound solvers run on the reduced problem
+  KnapsackReducedSolver<KnapsackDPSolver> DPRedSolver(DP_AUTO);
+  KnapsackReducedSolver<KnapsackBBSolver> BBRedSolver(UB3);
+  KnapsackBFSolver BFSolver;       // brute-force solver
+  KnapsackBTSolver BTSolver;       // backtracking solver
+  KnapsackBBSolver BBSolver1(UB1); // branch-and-bound solver with UB1
+  KnapsackBBSolver BBSolver2(UB2); // branch-and-bound solver with UB2
+  KnapsackBBSolver BBSolver3(UB3); // branch-and-bound solver with UB3
+  KnapsackBBSolver BBSolver4(UB4); // branch-and-bound solver with UB4
+  KnapsackBBSolver BBSolver5(UB5); // branch-and-bound solver with UB5
+  KnapsackBBSolver BBSolverBF(UB3, BB_BEST_FIRST); // best-first BB solver
+  KnapsackBBSolver BBSolverHY(UB3, BB_HYBRID);     // hybrid BB solver
+  KnapsackParallelBBSolver BBMTSolver(UB3,        // multi-threaded BB solver
+                                      std::thread::hardware_concurrency());
+  KnapsackSolution *DPSoln, *DPLMSoln, *DPBPSoln, *DPMTSoln,
+      *DPVSoln, *DPAutoSoln, *DPIncSoln, *ParetoSoln,
+      *CoreSoln, *DPRedSoln, *BBRedSoln, *BFSoln, *BTSoln, *BBSoln1,
+      *BBSoln2, *BBSoln3, *BBSoln4, *BBSoln5,
+      *BBSolnBF, *BBSolnHY, *BBMTSoln;
+
+  // The search statistics of the tree searching solvers are written to a
+  // JSON file if asked for. They are only recorded in builds with
+  // KNAPSACK_STATS.
+  char *program = argv[0];
+  char *statsPath = NULL;
+  if (argc >= 3 && strcmp(argv[1], "--stats") == 0) {
+    statsPath = argv[2];
+    argc -= 2;
+    argv += 2;
+  }
+
+  if (argc != 2 && argc != 3) {
+    printf("Invalid Number of command-line arguments\n");
+    printf("Usage: %s [--stats <json file>] <item count | instance file> "
+           "[binary output file]\n",
+           program);
+    exit(1);
+  }
+
+  // The argument is either a number of items to generate, or a file holding
+  // an instance in any format KnapsackInstanceFile reads.
+  char *end;
+  itemCnt = strtol(argv[1], &end, 10);
+  if (*end == '\0') {
+    if (itemCnt < 1) {
+      printf("Invalid number of items\n");
+      exit(1);
+    }
+    inst = new KnapsackInstance(itemCnt);
+    inst->Generate();
+  } else {
+    inst = InstanceFile.Read(argv[1]).release();
+    if (inst == NULL) {
+      printf("%s\n", InstanceFile.GetError().c_str());
+      exit(1);
+    }
+    itemCnt = inst->GetItemCnt();
+  }
+
+  if (argc == 3 && !InstanceFile.WriteBinary(*inst, argv[2])) {
+    printf("%s\n", InstanceFile.GetError().c_str());
+    exit(1);
+  }
+
+  DPSoln = new KnapsackSolution(inst);
+  DPLMSoln = new KnapsackSolution(inst);
+  DPBPSoln = new KnapsackSolution(inst);
+  DPMTSoln = new KnapsackSolution(inst);
+  DPVSoln = new KnapsackSolution(inst);
+  DPAutoSoln = new KnapsackSolution(inst);
+  DPIncSoln = new KnapsackSolution(inst);
+  ParetoSoln = new KnapsackSolution(inst);
+  CoreSoln = new KnapsackSolution(inst);
+  DPRedSoln = new KnapsackSolution(inst);
+  BBRedSoln = new KnapsackSolution(inst);
+  BFSoln = new KnapsackSolution(inst);
+  BTSoln = new KnapsackSolution(inst);
+  BBSoln1 = new KnapsackSolution(inst);
+  BBSoln2 = new KnapsackSolution(inst);
+  BBSoln3 = new KnapsackSolution(inst);
+  BBSoln4 = new KnapsackSolution(inst);
+  BBSoln5 = new KnapsackSolution(inst);
+  BBSolnBF = new KnapsackSolution(inst);
+  BBSolnHY = new KnapsackSolution(inst);
+  BBMTSoln = new KnapsackSolution(inst);
+
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    inst->Print();
+  else
+    printf("Number of items = %d, Capacity = %d\n", itemCnt,
+           inst->GetCapacity());
+
+  SetTime();
+  DPSolver.Solve(inst, DPSoln);
+  time = GetTime();
+  printf("\n\nSolved using dynamic programming (DP) in %ld ms. Optimal value "
+         "= %lld",
+         time, (long long)DPSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    DPSoln->Print("Dynamic Programming Solution");
+
+  SetTime();
+  DPLMSolver.Solve(inst, DPLMSoln);
+  time = GetTime();
+  printf("\n\nSolved using linear-memory dynamic programming (DP-LM) in %ld "
+         "ms. Optimal value = %lld",
+         time, (long long)DPLMSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    DPLMSoln->Print("Linear-Memory DP Solution");
+  if (DPSoln->GetValue() == DPLMSoln->GetValue())
+    printf("\nSUCCESS: DP and DP-LM solutions match");
+  else
+    printf("\nERROR: DP and DP-LM solutions mismatch");
+
+  SetTime();
+  DPBPSolver.Solve(inst, DPBPSoln);
+  time = GetTime();
+  printf("\n\nSolved using bit-packed dynamic programming (DP-BP) in %ld ms. "
+         "Optimal value = %lld",
+         time, (long long)DPBPSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    DPBPSoln->Print("Bit-Packed DP Solution");
+  if (DPSoln->GetValue() == DPBPSoln->GetValue())
+    printf("\nSUCCESS: DP and DP-BP solutions match");
+  else
+    printf("\nERROR: DP and DP-BP solutions mismatch");
+
+  SetTime();
+  DPMTSolver.Solve(inst, DPMTSoln);
+  time = GetTime();
+  printf("\n\nSolved using multi-threaded dynamic programming (DP-MT) with %u "
+         "threads in %ld ms. Optimal value = %lld",
+         std::thread::hardware_concurrency(), time,
+         (long long)DPMTSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    DPMTSoln->Print("Multi-Threaded DP Solution");
+  if (DPSoln->GetValue() == DPMTSoln->GetValue())
+    printf("\nSUCCESS: DP and DP-MT solutions match");
+  else
+    printf("\nERROR: DP and DP-MT solutions mismatch");
+
+  SetTime();
+  DPVSolver.Solve(inst, DPVSoln);
+  time = GetTime();
+  printf("\n\nSolved using value-indexed dynamic programming (DP-V) in %ld ms. "
+         "Optimal value = %lld",
+         time, (long long)DPVSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    DPVSoln->Print("Value-Indexed DP Solution");
+  if (DPSoln->GetValue() == DPVSoln->GetValue())
+    printf("\nSUCCESS: DP and DP-V solutions match");
+  else
+    printf("\nERROR: DP and DP-V solutions mismatch");
+
+  SetTime();
+  DPAutoSolver.Solve(inst, DPAutoSoln);
+  time = GetTime();
+  printf("\n\nSolved using dynamic programming with automatic orientation "
+         "(DP-AUTO) in %ld ms. Optimal value = %lld",
+         time, (long long)DPAutoSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    DPAutoSoln->Print("Automatically Oriented DP Solution");
+  if (DPSoln->GetValue() == DPAutoSoln->GetValue())
+    printf("\nSUCCESS: DP and DP-AUTO solutions match");
+  else
+    printf("\nERROR: DP and DP-AUTO solutions mismatch");
+
+  SetTime();
+  DPIncSolver.Solve(inst, DPIncSoln);
+  time = GetTime();
+  printf("\n\nSolved using incremental dynamic programming (DP-INC) in %ld "
+         "ms. Optimal value = %lld",
+         time, (long long)DPIncSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    DPIncSoln->Print("Incremental DP Solution");
+  if (DPSoln->GetValue() == DPIncSoln->GetValue())
+    printf("\nSUCCESS: DP and DP-INC solutions match");
+  else
+    printf("\nERROR: DP and DP-INC solutions mismatch");
+
+  SetTime();
+  ParetoSolver.Solve(inst, ParetoSoln);
+  time = GetTime();
+  printf("\n\nSolved using sparse Pareto-frontier DP (PF) in %ld ms. Optimal "
+         "value = %lld",
+         time, (long long)ParetoSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    ParetoSoln->Print("Pareto-Frontier Solution");
+  if (DPSoln->GetValue() == ParetoSoln->GetValue())
+    printf("\nSUCCESS: DP and PF solutions match");
+  else
+    printf("\nERROR: DP and PF solutions mismatch");
+
+  SetTime();
+  CoreSolver.Solve(inst, CoreSoln);
+  time = GetTime();
+  printf("\n\nSolved using an expanding core (CORE) of %zu items in %ld ms. "
+         "Optimal value = %lld",
+         CoreSolver.GetCoreSize(), time, (long long)CoreSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    CoreSoln->Print("Expanding-Core Solution");
+  if (DPSoln->GetValue() == CoreSoln->GetValue())
+    printf("\nSUCCESS: DP and CORE solutions match");
+  else
+    printf("\nERROR: DP and CORE solutions mismatch");
+
+  SetTime();
+  DPRedSolver.Solve(inst, DPRedSoln);
+  time = GetTime();
+  printf("\n\nSolved using DP after fixing %zu items by reduction (DP-RED) in "
+         "%ld ms. Optimal value = %lld",
+         DPRedSolver.GetReduction().GetFixedCount(), time,
+         (long long)DPRedSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    DPRedSoln->Print("DP-RED Solution");
+  if (DPSoln->GetValue() == DPRedSoln->GetValue())
+    printf("\nSUCCESS: DP and DP-RED solutions match");
+  else
+    printf("\nERROR: DP and DP-RED solutions mismatch");
+
+  SetTime();
+  BBRedSolver.Solve(inst, BBRedSoln);
+  time = GetTime();
+  printf("\n\nSolved using BB with UB3 after fixing %zu items by reduction "
+         "(BB-RED) in %ld ms. Optimal value = %lld",
+         BBRedSolver.GetReduction().GetFixedCount(), time,
+         (long long)BBRedSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    BBRedSoln->Print("BB-RED Solution");
+  if (DPSoln->GetValue() == BBRedSoln->GetValue())
+    printf("\nSUCCESS: DP and BB-RED solutions match");
+  else
+    printf("\nERROR: DP and BB-RED solutions mismatch");
+
+  SetTime();
+  BFSolver.Solve(inst, BFSoln);
+  BFTime = time = GetTime();
+  printf("\n\nSolved using brute-force enumeration (BF) in %ld ms. Optimal "
+         "value = %lld",
+         time, (long long)BFSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    BFSoln->Print("Brute-Force Solution");
+  if (DPSoln->GetValue() == BFSoln->GetValue())
+    printf("\nSUCCESS: DP and BF solutions match");
+  else
+    printf("\nERROR: DP and BF solutions mismatch");
+
+  SetTime();
+  BTSolver.Solve(inst, BTSoln);
+  time = GetTime();
+  printf("\n\nSolved using backtracking (BT) in %ld ms. Optimal value = %lld",
+         time, (long long)BTSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    BTSoln->Print("Backtracking Solution");
+  if (BFSoln->GetValue() == BTSoln->GetValue())
+    printf("\nSUCCESS: BF and BT solutions match");
+  else
+    printf("\nERROR: BF and BT solutions mismatch");
+  speedup = time == 0 ? 0 : 100.0 * (BFTime - time) / (float)BFTime;
+  printf("\nSpeedup of BT relative to BF is %.2f%c", speedup, '%');
+
+  SetTime();
+  BBSolver1.Solve(inst, BBSoln1);
+  time = GetTime();
+  printf("\n\nSolved using branch-and-bound (BB) with UB1 in %ld ms, "
+         "exploring %llu nodes. Optimal value = %lld",
+         time, (unsigned long long)BBSolver1.GetNodeCount(),
+         (long long)BBSoln1->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    BBSoln1->Print("BB-UB1 Solution");
+  if (BFSoln->GetValue() == BBSoln1->GetValue())
+    printf("\nSUCCESS: BF and BB-UB1 solutions match");
+  else
+    printf("\nERROR: BF and BB-UB1 solutions mismatch");
+  speedup = time == 0 ? 0 : 100.0 * (BFTime - time) / (float)BFTime;
+  printf("\nSpeedup of BB-UB1 relative to BF is %.2f%c", speedup, '%');
+
+  SetTime();
+  BBSolver2.Solve(inst, BBSoln2);
+  time = GetTime();
+  printf("\n\nSolved using branch-and-bound (BB) with UB2 in %ld ms, "
+         "exploring %llu nodes. Optimal value = %lld",
+         time, (unsigned long long)BBSolver2.GetNodeCount(),
+         (long long)BBSoln2->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    BBSoln2->Print("BB-UB2 Solution");
+  if (BFSoln->GetValue() == BBSoln2->GetValue())
+    printf("\nSUCCESS: BF and BB-UB2 solutions match");
+  else
+    printf("\nERROR: BF and BB-UB2 solutions mismatch");
+  speedup = time == 0 ? 0 : 100.0 * (BFTime - time) / (float)BFTime;
+  printf("\nSpeedup of BB-UB2 relative to BF is %.2f%c", speedup, '%');
+
+  SetTime();
+  BBSolver3.Solve(inst, BBSoln3);
+  time = GetTime();
+  printf("\n\nSolved using branch-and-bound (BB) with UB3 in %ld ms, "
+         "exploring %llu nodes. Optimal value = %lld",
+         time, (unsigned long long)BBSolver3.GetNodeCount(),
+         (long long)BBSoln3->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    BBSoln3->Print("BB-UB3 Solution");
+  if (BFSoln->GetValue() == BBSoln3->GetValue())
+    printf("\nSUCCESS: BF and BB-UB3 solutions match");
+  else
+    printf("\nERROR: BF and BB-UB3 solutions mismatch");
+  speedup = time == 0 ? 0 : 100.0 * (BFTime - time) / (float)BFTime;
+  printf("\nSpeedup of BB-UB3 relative to BF is %.2f%c", speedup, '%');
+
+  SetTime();
+  BBSolver4.Solve(inst, BBSoln4);
+  time = GetTime();
+  printf("\n\nSolved using branch-and-bound (BB) with UB4 in %ld ms, "
+         "exploring %llu nodes. Optimal value = %lld",
+         time, (unsigned long long)BBSolver4.GetNodeCount(),
+         (long long)BBSoln4->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    BBSoln4->Print("BB-UB4 Solution");
+  if (BFSoln->GetValue() == BBSoln4->GetValue())
+    printf("\nSUCCESS: BF and BB-UB4 solutions match");
+  else
+    printf("\nERROR: BF and BB-UB4 solutions mismatch");
+  speedup = time == 0 ? 0 : 100.0 * (BFTime - time) / (float)BFTime;
+  printf("\nSpeedup of BB-UB4 relative to BF is %.2f%c", speedup, '%');
+
+  SetTime();
+  BBSolver5.Solve(inst, BBSoln5);
+  time = GetTime();
+  printf("\n\nSolved using branch-and-bound (BB) with UB5 in %ld ms, "
+         "exploring %llu nodes. Optimal value = %lld",
+         time, (unsigned long long)BBSolver5.GetNodeCount(),
+         (long long)BBSoln5->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    BBSoln5->Print("BB-UB5 Solution");
+  if (BFSoln->GetValue() == BBSoln5->GetValue())
+    printf("\nSUCCESS: BF and BB-UB5 solutions match");
+  else
+    printf("\nERROR: BF and BB-UB5 solutions mismatch");
+  speedup = time == 0 ? 0 : 100.0 * (BFTime - time) / (float)BFTime;
+  printf("\nSpeedup of BB-UB5 relative to BF is %.2f%c", speedup, '%');
+
+  SetTime();
+  BBSolverBF.Solve(inst, BBSolnBF);
+  time = GetTime();
+  printf("\n\nSolved using best-first branch-and-bound (BB-BF) in %ld ms, "
+         "exploring %llu nodes. Optimal value = %lld",
+         time, (unsigned long long)BBSolverBF.GetNodeCount(),
+         (long long)BBSolnBF->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    BBSolnBF->Print("BB-BF Solution");
+  if (BBSoln3->GetValue() == BBSolnBF->GetValue())
+    printf("\nSUCCESS: BB-UB3 and BB-BF solutions match");
+  else
+    printf("\nERROR: BB-UB3 and BB-BF solutions mismatch");
+
+  SetTime();
+  BBSolverHY.Solve(inst, BBSolnHY);
+  time = GetTime();
+  printf("\n\nSolved using hybrid branch-and-bound (BB-HY) in %ld ms, "
+         "exploring %llu nodes. Optimal value = %lld",
+         time, (unsigned long long)BBSolverHY.GetNodeCount(),
+         (long long)BBSolnHY->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    BBSolnHY->Print("BB-HY Solution");
+  if (BBSoln3->GetValue() == BBSolnHY->GetValue())
+    printf("\nSUCCESS: BB-UB3 and BB-HY solutions match");
+  else
+    printf("\nERROR: BB-UB3 and BB-HY solutions mismatch");
+
+  SetTime();
+  BBMTSolver.Solve(inst, BBMTSoln);
+  time = GetTime();
+  printf("\n\nSolved using multi-threaded branch-and-bound (BB-MT) with %u "
+         "threads in %ld ms, exploring %llu nodes. Optimal value = %lld",
+         std::thread::hardware_concurrency(), time,
+         (unsigned long long)BBMTSolver.GetNodeCount(),
+         (long long)BBMTSoln->GetValue());
+  if (itemCnt <= MAX_SIZE_TO_PRINT)
+    BBMTSoln->Print("BB-MT Solution");
+  if (BBSoln3->GetValue() == BBMTSoln->GetValue())
+    printf("\nSUCCESS: BB-UB3 and BB-MT solutions match");
+  else
+    printf("\nERROR: BB-UB3 and BB-MT solutions mismatch");
+
+  CheckLargeValues();
+
+  if (statsPath != NULL) {
+    FILE *statsFile = fopen(statsPath, "w");
+    if (statsFile == NULL) {
+      printf("\n\nCannot write search statistics to %s", statsPath);
+    } else {
+      std::pair<char const *, KnapsackSearchStats const *> solverStats[] = {
+          {"BF", &BFSolver.GetStats()},
+          {"BT", &BTSolver.GetStats()},
+          {"BB-UB1", &BBSolver1.GetStats()},
+          {"BB-UB2", &BBSolver2.GetStats()},
+          {"BB-UB3", &BBSolver3.GetStats()},
+          {"BB-UB4", &BBSolver4.GetStats()},
+          {"BB-UB5", &BBSolver5.GetStats()},
+          {"BB-BF", &BBSolverBF.GetStats()},
+          {"BB-HY", &BBSolverHY.GetStats()},
+          {"BB-MT", &BBMTSolver.GetStats()},
+          {"BB-RED", &BBRedSolver.GetSolver().GetStats()}};
+
+      fprintf(statsFile, "{");
+      for (size_t i = 0; i < sizeof(solverStats) / sizeof(*solverStats);
+           ++i) {
+        fprintf(statsFile, "%s\n  \"%s\": ", i == 0 ? "" : ",",
+                solverStats[i].first);
+        solverStats[i].second->WriteJson(statsFile, 2);
+      }
+      fprintf(statsFile, "\n}\n");
+      fclose(statsFile);
+      printf("\n\nWrote search statistics to %s", statsPath);
+    }
+  }
+
+  delete inst;
+  delete DPSoln;
+  delete DPLMSoln;
+  delete DPBPSoln;
+  delete DPMTSoln;
+  delete DPVSoln;
+  delete DPAutoSoln;
+  delete DPIncSoln;
+  delete ParetoSoln;
+  delete CoreSoln;
+  delete DPRedSoln;
+  delete BBRedSoln;
+  delete BFSoln;
+  delete BTSoln;
+  delete BBSoln1;
+  delete BBSoln2;
+  delete BBSoln3;
+  delete BBSoln4;
+  delete BBSoln5;
+  delete BBSolnBF;
+  delete BBSolnHY;
+  delete BBMTSoln;
+
+  printf("\n\nProgram Completed Successfully\n");
 
-int main() {
-  std::cout << "Hello, World!" << std::endl;
   return 0;
-}
\ No newline at end of file
+}
+
+//===-- Checks on fixed instances -----------------------------------------===//
+
+/// Check the branch-and-bound solvers against the core solver on an instance
+/// whose optimal value does not fit in an int32_t, though each item's does.
+/// The warm start is turned off, so that the search itself must sum the
+/// values.
+void CheckLargeValues(void) {
+  int const weights[] = {10, 10, 10, 11};
+  int const values[] = {1500000000, 1400000000, 1300000000, 1200000000};
+  KnapsackInstance inst(4);
+
+  inst.SetCapacity(30);
+  for (int i = 1; i <= 4; i++)
+    inst.SetItem(i, weights[i - 1], values[i - 1]);
+
+  KnapsackCoreSolver coreSolver;
+  KnapsackSolution coreSoln(&inst);
+  coreSolver.Solve(&inst, &coreSoln);
+
+  UPPER_BOUND const bounds[] = {UB1, UB2, UB3, UB4, UB5};
+  BB_SEARCH const searches[] = {BB_DEPTH_FIRST, BB_BEST_FIRST, BB_HYBRID};
+  char const *searchNames[] = {"depth-first", "best-first", "hybrid"};
+  bool allMatch = true;
+
+  for (int b = 0; b < 5; b++) {
+    for (int s = 0; s < 3; s++) {
+      KnapsackBBSolver solver(bounds[b], searches[s]);
+      KnapsackSolution soln(&inst);
+
+      solver.SetWarmStart(false);
+      solver.Solve(&inst, &soln);
+      if (soln.GetValue() != coreSoln.GetValue()) {
+        printf("\nERROR: %s BB-UB%d and CORE solutions mismatch on values "
+               "past INT32_MAX: %lld and %lld",
+               searchNames[s], b + 1, (long long)soln.GetValue(),
+               (long long)coreSoln.GetValue());
+        allMatch = false;
+      }
+    }
+  }
+
+  KnapsackParallelBBSolver parallelSolver(UB3,
+                                          std::thread::hardware_concurrency());
+  KnapsackSolution parallelSoln(&inst);
+
+  parallelSolver.SetWarmStart(false);
+  parallelSolver.Solve(&inst, &parallelSoln);
+  if (parallelSoln.GetValue() != coreSoln.GetValue()) {
+    printf("\nERROR: BB-MT and CORE solutions mismatch on values past "
+           "INT32_MAX: %lld and %lld",
+           (long long)parallelSoln.GetValue(), (long long)coreSoln.GetValue());
+    allMatch = false;
+  }
+
+  if (allMatch)
+    printf("\nSUCCESS: BB and CORE solutions match on values past INT32_MAX");
+}
+
+//===-- Time related functions --------------------------------------------===//
+
+UDT_TIME GetCurrentTime(void) {
+  UDT_TIME crntTime = 0;
+
+  TIMEB timeBuf;
+  FTIME(&timeBuf);
+  crntTime = GetMilliSecondTime(timeBuf);
+
+  return crntTime;
+}
+
+void SetTime(void) { gRefTime = GetCurrentTime(); }
+
+UDT_TIME GetTime(void) {
+  UDT_TIME crntTime = GetCurrentTime();
+
+  return (crntTime - gRefTime);
+}
+
+UDT_TIME GetMilliSecondTime(TIMEB timeBuf) {
+  UDT_TIME mliScndTime;
+
+  mliScndTime = timeBuf.time;
+  mliScndTime *= 1000;
+  mliScndTime += timeBuf.millitm;
+  return mliScndTime;
+}
@@ -0,0 +1,548 @@
+//===-- server.cpp - 0/1 Knapsack Problem solver server -------------------===//
+//
+// Author: Michael Dorst
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file contains the KnapsackServer program, which solves the instances
+/// clients send it on a pool of threads that keep their solvers, and their
+/// solvers' buffers, from one request to the next.
+///
+/// It listens on a Unix domain socket, or with --stdio reads one stream of
+/// requests from stdin and writes the responses to stdout until stdin ends.
+/// Frames are those of KnapsackStream. A client may send many requests
+/// before reading any responses, and gets each response as soon as its
+/// request is solved, so responses may come back in a different order than
+/// the requests; their ids tell them apart.
+///
+/// Requests wait in one queue, bounded both by a number of requests and by
+/// the bytes of the items of the requests queued or being solved. A reader
+/// reads a request's header, and waits for room for its items before
+/// reading them, so a client that sends faster than the workers solve is
+/// slowed down by its socket filling up. The server's memory is then about
+/// --queue-mib, and the solvers' buffers, however many clients there are.
+/// Workers take up to --batch requests at a time, so that under load they
+/// lock the queue once per batch rather than once per request.
+///
+/// On SIGINT or SIGTERM the server stops accepting connections and reading
+/// requests, answers the requests already queued, and removes its socket.
+///
+/// With --cache, solutions are remembered by a hash of their instances, and
+/// an instance sent again is answered without solving it. RQ_BB solutions
+/// are only remembered if the search finished within its budget.
+//===----------------------------------------------------------------------===//
+
+#include "KnapsackBBSolver.h"
+#include "KnapsackCoreSolver.h"
+#include "KnapsackDPSolver.h"
+#include "KnapsackProtocol.h"
+#include "KnapsackSolutionCache.h"
+#include "Time.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <new>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+struct Options {
+  std::string socketPath;
+  bool stdio = false;
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  /// The most requests waiting to be solved
+  size_t queueSize = 1024;
+  /// The most MiB of items queued or being solved
+  size_t queueMiB = 256;
+  /// The most requests a worker takes at a time
+  size_t batchSize = 16;
+  /// The most solutions to remember in memory, or 0 for no cache
+  size_t cacheEntries = 0;
+  /// The file to remember solutions in across restarts, if any
+  std::string cacheFile;
+  uint64_t cacheFileMiB = 256;
+};
+
+/// A request, and the connection to answer it on
+struct Job {
+  KnapsackRequest request;
+  std::shared_ptr<KnapsackStream> stream;
+  /// The bytes reserved for the request's items
+  size_t bytes = 0;
+};
+
+/// The bytes a request's items take once read
+static size_t requestBytes(KnapsackRequestHeader const &header) {
+  return sizeof(KnapsackInstance) + 2 * sizeof(int32_t) * header.itemCount;
+}
+
+/// The requests waiting for a worker, shared by every connection.
+class RequestQueue {
+private:
+  std::mutex mutex;
+  std::condition_variable notEmpty, notFull, bytesFreed;
+  std::deque<Job> jobs;
+  size_t const capacity;
+  size_t const byteBudget;
+  /// The bytes of the requests being read, queued or being solved
+  size_t reservedBytes = 0;
+  unsigned const workerCount;
+  bool closed = false;
+
+public:
+  RequestQueue(size_t capacity, size_t byteBudget, unsigned workerCount)
+      : capacity(std::max<size_t>(capacity, 1)), byteBudget(byteBudget),
+        workerCount(workerCount) {}
+
+  /// Reserve room for a request's items before reading them, waiting while
+  /// the requests already reserved leave too little. A request larger than
+  /// the whole budget waits until it would be the only one.
+  /// \return Whether room was reserved. False once the queue is closed.
+  bool Reserve(size_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex);
+    bytesFreed.wait(lock, [this, bytes] {
+      return closed || reservedBytes == 0 ||
+             reservedBytes + bytes <= byteBudget;
+    });
+    if (closed) {
+      return false;
+    }
+    reservedBytes += bytes;
+    return true;
+  }
+
+  /// Give back the room of a request that has been answered, or not read.
+  void Release(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    reservedBytes -= bytes;
+    bytesFreed.notify_all();
+  }
+
+  /// Add a job, waiting while the queue is full.
+  /// \return Whether it was added. False once the queue is closed.
+  bool Push(Job &&job) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notFull.wait(lock, [this] { return jobs.size() < capacity || closed; });
+    if (closed) {
+      return false;
+    }
+    jobs.push_back(std::move(job));
+    notEmpty.notify_one();
+    return true;
+  }
+
+  /// Take up to `maxCount` jobs, waiting while the queue is empty. Jobs are
+  /// shared out between the workers, so that no worker takes a whole batch
+  /// while others have nothing to do.
+  /// \return Whether any were taken. False once the queue is closed and
+  /// empty.
+  bool PopBatch(std::vector<Job> &batch, size_t maxCount) {
+    std::unique_lock<std::mutex> lock(mutex);
+    notEmpty.wait(lock, [this] { return !jobs.empty() || closed; });
+    if (jobs.empty()) {
+      return false;
+    }
+
+    size_t share = (jobs.size() + workerCount - 1) / workerCount;
+    size_t count = std::min(std::max<size_t>(maxCount, 1), share);
+    for (size_t j = 0; j < count; ++j) {
+      batch.push_back(std::move(jobs.front()));
+      jobs.pop_front();
+    }
+    notFull.notify_all();
+    if (!jobs.empty()) {
+      notEmpty.notify_one();
+    }
+    return true;
+  }
+
+  /// Take no more jobs, and let the workers finish once the queue is empty.
+  void Close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    notEmpty.notify_all();
+    notFull.notify_all();
+    bytesFreed.notify_all();
+  }
+};
+
+/// A thread of the pool, with a warm solver of every kind.
+class Worker {
+private:
+  /// Shared by every worker, or null
+  KnapsackSolutionCache *cache;
+  KnapsackCoreSolver coreSolver;
+  KnapsackDPSolver dpSolver{DP_AUTO};
+  KnapsackBBSolver bbSolver{UB3};
+
+  /// Solve a request.
+  /// \param [out] response The header of the response, but for its id
+  void solve(KnapsackRequest const &request, KnapsackSolution *solution,
+             KnapsackResponseHeader &response) {
+
+    KnapsackInstance *instance = request.instance.get();
+
+    switch (request.header.solver) {
+    case RQ_CORE:
+      coreSolver.Solve(instance, solution);
+      response.upperBound = solution->GetValue();
+      break;
+    case RQ_DP:
+      dpSolver.Solve(instance, solution);
+      response.upperBound = solution->GetValue();
+      break;
+    case RQ_BB: {
+      KnapsackBudget budget;
+      if (request.header.budgetMicroseconds != 0) {
+        budget.time =
+            std::chrono::microseconds(request.header.budgetMicroseconds);
+      }
+      response.upperBound =
+          bbSolver.SolveAnytime(instance, solution, budget).upperBound;
+      break;
+    }
+    }
+    response.value = solution->GetValue();
+  }
+
+  /// Whether a solution is proved optimal, and so may be remembered. A
+  /// solver whose sums could have overflowed proves nothing, even when its
+  /// value and bound agree.
+  static bool isProvedOptimal(KnapsackRequest const &request,
+                              KnapsackResponseHeader const &response) {
+    REQUEST_SOLVER solver = (REQUEST_SOLVER)request.header.solver;
+
+    return response.upperBound == response.value &&
+           request.instance->GetValueSum() <= requestMaxValueSum(solver);
+  }
+
+public:
+  explicit Worker(KnapsackSolutionCache *cache) : cache(cache) {}
+
+  void Run(RequestQueue &queue, size_t batchSize) {
+    std::vector<Job> batch;
+
+    while (queue.PopBatch(batch, batchSize)) {
+      for (Job &job : batch) {
+        KnapsackRequest const &request = job.request;
+        KnapsackResponseHeader response;
+        memset(&response, 0, sizeof response);
+        response.id = request.header.id;
+
+        if (request.instance == nullptr) {
+          response.status = RS_INVALID;
+          job.stream->WriteResponse(response, nullptr);
+          queue.Release(job.bytes);
+          continue;
+        }
+
+        auto startTime = getTime();
+        std::unique_ptr<KnapsackSolution> solution;
+        try {
+          solution.reset(new KnapsackSolution(request.instance.get()));
+          if (cache != nullptr &&
+              cache->Find(*request.instance, solution.get())) {
+            response.value = response.upperBound = solution->GetValue();
+          } else {
+            solve(request, solution.get(), response);
+            if (cache != nullptr && isProvedOptimal(request, response)) {
+              cache->Insert(*request.instance, solution.get());
+            }
+          }
+          response.status = RS_SOLVED;
+          response.itemCount = request.instance->GetItemCnt();
+        } catch (std::bad_alloc const &) {
+          response.status = RS_OUT_OF_MEMORY;
+          solution.reset();
+        }
+        response.nanoseconds = (uint64_t)(timeSince(startTime).count() * 1e9);
+
+        // A client that has gone away is not an error; its reader sees the
+        // end of the stream and stops
+        job.stream->WriteResponse(response, solution.get());
+
+        // Free the items before giving their room back
+        solution.reset();
+        job.request.instance.reset();
+        queue.Release(job.bytes);
+      }
+      batch.clear();
+    }
+  }
+};
+
+static char socketPath[sizeof(sockaddr_un::sun_path)];
+
+/// Written to by the signal handler, to wake the accepting loop
+static int shutdownPipe[2];
+
+static void requestShutdown(int) {
+  int savedErrno = errno;
+  char byte = 0;
+  ssize_t written = write(shutdownPipe[1], &byte, 1);
+  (void)written;
+  errno = savedErrno;
+}
+
+static void usage(char const *program) {
+  printf("Usage: %s (--socket PATH | --stdio) [options]\n"
+         "  --socket PATH  listen on the Unix domain socket PATH\n"
+         "  --stdio        read requests from stdin and write responses to "
+         "stdout\n"
+         "  --threads T    requests solved at once (default: cores)\n"
+         "  --queue N      most requests waiting to be solved (default: "
+         "1024)\n"
+         "  --queue-mib M  most MiB of items queued or being solved "
+         "(default: 256)\n"
+         "  --batch N      most requests a thread takes at a time (default: "
+         "16)\n"
+         "  --cache N      remember up to N solutions in memory\n"
+         "  --cache-file PATH\n"
+         "                 also remember solutions in PATH, across restarts\n"
+         "  --cache-size MIB\n"
+         "                 size of a new --cache-file (default: 256)\n",
+         program);
+}
+
+static Options parseOptions(int argc, char *argv[]) {
+  Options options;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string option = argv[i];
+
+    if (option == "--help" || option == "-h") {
+      usage(argv[0]);
+      exit(0);
+    }
+    if (option == "--stdio") {
+      options.stdio = true;
+      continue;
+    }
+    if (i + 1 == argc) {
+      printf("Missing the value of %s\n", option.c_str());
+      exit(1);
+    }
+    char const *value = argv[++i];
+
+    if (option == "--socket") {
+      options.socketPath = value;
+    } else if (option == "--threads") {
+      options.threads = std::max(1, atoi(value));
+    } else if (option == "--queue") {
+      options.queueSize = std::max(1, atoi(value));
+    } else if (option == "--queue-mib") {
+      options.queueMiB = std::max(1, atoi(value));
+    } else if (option == "--batch") {
+      options.batchSize = std::max(1, atoi(value));
+    } else if (option == "--cache") {
+      options.cacheEntries = strtoull(value, NULL, 10);
+    } else if (option == "--cache-file") {
+      options.cacheFile = value;
+    } else if (option == "--cache-size") {
+      options.cacheFileMiB = strtoull(value, NULL, 10);
+    } else {
+      printf("Unknown option %s\n", option.c_str());
+      usage(argv[0]);
+      exit(1);
+    }
+  }
+
+  if (options.stdio == !options.socketPath.empty()) {
+    usage(argv[0]);
+    exit(1);
+  }
+  if (options.socketPath.size() >= sizeof socketPath) {
+    printf("%s: path too long for a socket\n", options.socketPath.c_str());
+    exit(1);
+  }
+  return options;
+}
+
+/// Queue every request of a connection until it ends or sends a corrupt
+/// frame. The connection stays open until its last response is written.
+static void readRequests(std::shared_ptr<KnapsackStream> stream,
+                         RequestQueue &queue) {
+  Job job;
+  while (stream->ReadRequestHeader(job.request.header)) {
+    job.bytes = requestBytes(job.request.header);
+    if (!queue.Reserve(job.bytes)) {
+      break;
+    }
+    if (!stream->ReadRequestItems(job.request)) {
+      queue.Release(job.bytes);
+      break;
+    }
+    job.stream = stream;
+    if (!queue.Push(std::move(job))) {
+      queue.Release(job.bytes);
+      break;
+    }
+    job = Job();
+  }
+}
+
+/// The connections whose requests are being read.
+class ConnectionSet {
+private:
+  std::mutex mutex;
+  std::condition_variable readersDone;
+  std::set<int> fds;
+
+public:
+  void Add(int fd) {
+    std::lock_guard<std::mutex> lock(mutex);
+    fds.insert(fd);
+  }
+
+  /// Note that a connection's reader has finished.
+  void Remove(int fd) {
+    std::lock_guard<std::mutex> lock(mutex);
+    fds.erase(fd);
+    readersDone.notify_all();
+  }
+
+  /// Stop reading from every connection, and wait for the readers to
+  /// finish. Responses can still be written.
+  void StopReading() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (int fd : fds) {
+      shutdown(fd, SHUT_RD);
+    }
+    readersDone.wait(lock, [this] { return fds.empty(); });
+  }
+};
+
+/// Listen on the socket, reading each connection's requests on a thread of
+/// its own, until SIGINT or SIGTERM. Then stop reading, close the queue and
+/// remove the socket.
+static void serve(Options const &options, RequestQueue &queue) {
+  strcpy(socketPath, options.socketPath.c_str());
+  unlink(socketPath);
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address;
+  memset(&address, 0, sizeof address);
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, socketPath);
+
+  if (listener < 0 ||
+      bind(listener, (sockaddr *)&address, sizeof address) != 0 ||
+      listen(listener, SOMAXCONN) != 0) {
+    printf("%s: %s\n", socketPath, strerror(errno));
+    exit(1);
+  }
+  if (pipe(shutdownPipe) != 0) {
+    printf("pipe: %s\n", strerror(errno));
+    exit(1);
+  }
+  signal(SIGINT, requestShutdown);
+  signal(SIGTERM, requestShutdown);
+
+  ConnectionSet connections;
+  pollfd waitFor[2] = {{listener, POLLIN, 0}, {shutdownPipe[0], POLLIN, 0}};
+
+  while (true) {
+    if (poll(waitFor, 2, -1) < 0) {
+      if (errno != EINTR) {
+        printf("poll: %s\n", strerror(errno));
+      }
+      continue;
+    }
+    if (waitFor[1].revents != 0) {
+      break;
+    }
+    if (waitFor[0].revents == 0) {
+      continue;
+    }
+
+    int connection = accept(listener, NULL, NULL);
+    if (connection < 0) {
+      if (errno != EINTR && errno != ECONNABORTED) {
+        printf("accept: %s\n", strerror(errno));
+      }
+      continue;
+    }
+    auto stream = std::make_shared<KnapsackStream>(connection, connection,
+                                                   true);
+    connections.Add(connection);
+    std::thread([stream, connection, &queue, &connections] {
+      readRequests(stream, queue);
+      connections.Remove(connection);
+    }).detach();
+  }
+
+  close(listener);
+  unlink(socketPath);
+  // Wake the readers waiting for room before stopping them, and let the
+  // workers answer what is queued
+  queue.Close();
+  connections.StopReading();
+}
+
+int main(int argc, char *argv[]) {
+  Options options = parseOptions(argc, argv);
+
+  // Writing to a client that has gone away fails rather than killing the
+  // server
+  signal(SIGPIPE, SIG_IGN);
+
+  std::unique_ptr<KnapsackSolutionCache> cache;
+  if (options.cacheEntries > 0 || !options.cacheFile.empty()) {
+    cache.reset(new KnapsackSolutionCache(options.cacheEntries));
+    if (!options.cacheFile.empty() &&
+        !cache->OpenDisk(options.cacheFile, options.cacheFileMiB << 20)) {
+      printf("%s\n", cache->GetError().c_str());
+      return 1;
+    }
+  }
+
+  RequestQueue queue(options.queueSize, options.queueMiB << 20,
+                     options.threads);
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> threads;
+
+  for (unsigned t = 0; t < options.threads; ++t) {
+    workers.emplace_back(new Worker(cache.get()));
+    threads.emplace_back(&Worker::Run, workers.back().get(), std::ref(queue),
+                         options.batchSize);
+  }
+
+  if (options.stdio) {
+    readRequests(std::make_shared<KnapsackStream>(STDIN_FILENO,
+                                                  STDOUT_FILENO, false),
+                 queue);
+    queue.Close();
+  } else {
+    serve(options, queue);
+  }
+
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  if (cache != nullptr) {
+    // stdout carries the responses
+    KnapsackCacheStats stats = cache->GetStats();
+    fprintf(stderr,
+            "cache: %llu memory hits, %llu disk hits, %llu misses, %llu "
+            "memory evictions, %llu disk evictions\n",
+            (unsigned long long)stats.memoryHits,
+            (unsigned long long)stats.diskHits,
+            (unsigned long long)stats.misses,
+            (unsigned long long)stats.memoryEvictions,
+            (unsigned long long)stats.diskEvictions);
+  }
+  return 0;
+}